@@ -0,0 +1,178 @@
+/* Tests du journal en flash après une coupure d'alimentation
+ *
+ * Lancé comme l'application par le noyau de simulation, sur la flash
+ * simulée (FlashIAP de simPeripherals.cpp). Une coupure est figurée en
+ * abandonnant le FlashLog : un nouveau doit tout retrouver par init()
+ * à partir de la flash seule. Cas couverts :
+ * - coupure entre deux cycles ;
+ * - enregistrement à moitié programmé (tête sur un double mot écrit) ;
+ * - secteur effacé à l'entrée de la tête, puis coupure avant toute
+ *   programmation, la zone ayant déjà fait le tour.
+ *
+ * Un message par test en échec ; le cycle se termine par power_off()
+ * si tout passe, en échec sinon.
+ *
+ * Lancé par make check (voir Makefile)
+ */
+
+#include "mbed.h"
+#include "flashLog.hpp"
+
+// Zone de test : 4 secteurs de 2 ko, 85 enregistrements chacun
+#define ZONE_ADDRESS 0x08030000UL
+#define ZONE_SECTORS 4
+#define SECTOR_SIZE 2048
+#define PER_SECTOR (SECTOR_SIZE / sizeof(LogRecord))
+#define CAPACITY (ZONE_SECTORS * PER_SECTOR)
+
+static int failures = 0;
+
+#define CHECK(cond) check((cond), #cond, __LINE__)
+
+static void check(bool ok, const char *what, int line)
+{
+    if (!ok) {
+        printf("flashLogCheck:%d: %s\n", line, what);
+        failures++;
+    }
+}
+
+// Trame reconnaissable d'après le numéro de la mesure
+static void fill(uint32_t seq, uint8_t frame[])
+{
+    for (int i = 0; i < TELEMETRY_FRAME_MAX; i++) {
+        frame[i] = (uint8_t)(seq * 7 + i);
+    }
+}
+
+static void append(FlashLog &log, uint32_t n)
+{
+    uint8_t frame[TELEMETRY_FRAME_MAX];
+    for (uint32_t i = 0; i < n; i++) {
+        fill(log.next(), frame);
+        log.append(frame, 1000 + log.next());
+    }
+    CHECK(log.flush() == 0);
+}
+
+// Relit les mesures de first à next : toutes présentes sauf skip
+static void verify(FlashLog &log, uint32_t skip = UINT32_MAX)
+{
+    LogRecord records[8];
+    uint8_t frame[TELEMETRY_FRAME_MAX];
+    uint32_t seq = log.first();
+    while (seq < log.next()) {
+        int n = log.read(seq, records, 8);
+        CHECK(n > 0);
+        if (n <= 0) {
+            return;
+        }
+        for (int k = 0; k < n; k++) {
+            if (seq == skip) {
+                seq++;
+            }
+            CHECK(records[k].seq == seq);
+            CHECK(records[k].time == 1000 + seq);
+            fill(seq, frame);
+            CHECK(memcmp(records[k].frame, frame, sizeof(frame)) == 0);
+            seq = records[k].seq + 1;
+        }
+    }
+}
+
+// Coupure entre deux cycles : tête et numéros retrouvés
+static void checkReboot(FlashIAP &flash)
+{
+    flash.erase(ZONE_ADDRESS, ZONE_SECTORS * SECTOR_SIZE);
+    {
+        FlashLog log(ZONE_ADDRESS, ZONE_SECTORS * SECTOR_SIZE);
+        CHECK(log.init() == 0);
+        CHECK(log.count() == 0);
+        append(log, 10);
+    }
+    FlashLog log(ZONE_ADDRESS, ZONE_SECTORS * SECTOR_SIZE);
+    CHECK(log.init() == 0);
+    CHECK(log.first() == 0);
+    CHECK(log.next() == 10);
+    verify(log);
+    // La suite se programme derrière, sans PROGERR
+    append(log, PER_SECTOR);
+    verify(log);
+}
+
+// Coupure pendant la programmation : seul le premier double mot est écrit
+static void checkTornRecord(FlashIAP &flash)
+{
+    flash.erase(ZONE_ADDRESS, ZONE_SECTORS * SECTOR_SIZE);
+    {
+        FlashLog log(ZONE_ADDRESS, ZONE_SECTORS * SECTOR_SIZE);
+        CHECK(log.init() == 0);
+        append(log, 20);
+    }
+    LogRecord torn;
+    memset(&torn, 0, sizeof(torn));
+    torn.seq = 20;
+    torn.time = 1020;
+    CHECK(flash.program(&torn, ZONE_ADDRESS + 20 * sizeof(LogRecord), 8) == 0);
+
+    FlashLog log(ZONE_ADDRESS, ZONE_SECTORS * SECTOR_SIZE);
+    CHECK(log.init() == 0);
+    // L'enregistrement interrompu est sauté avec son numéro
+    CHECK(log.next() == 21);
+    append(log, 5);
+    verify(log, 20);
+
+    // Et le reste à la coupure suivante
+    FlashLog again(ZONE_ADDRESS, ZONE_SECTORS * SECTOR_SIZE);
+    CHECK(again.init() == 0);
+    CHECK(again.first() == 0);
+    CHECK(again.next() == 26);
+    verify(again, 20);
+}
+
+/* Coupure juste après l'effacement du secteur où entre la tête : il
+ * est vierge, les plus anciennes mesures qu'il portait sont perdues */
+static void checkErasedSector(FlashIAP &flash)
+{
+    flash.erase(ZONE_ADDRESS, ZONE_SECTORS * SECTOR_SIZE);
+    {
+        FlashLog log(ZONE_ADDRESS, ZONE_SECTORS * SECTOR_SIZE);
+        CHECK(log.init() == 0);
+        // Un tour complet : la tête revient au début du secteur 1
+        append(log, CAPACITY + PER_SECTOR);
+        CHECK(log.first() == PER_SECTOR);
+    }
+    CHECK(flash.erase(ZONE_ADDRESS + SECTOR_SIZE, SECTOR_SIZE) == 0);
+
+    FlashLog log(ZONE_ADDRESS, ZONE_SECTORS * SECTOR_SIZE);
+    CHECK(log.init() == 0);
+    CHECK(log.next() == CAPACITY + PER_SECTOR);
+    CHECK(log.first() == 2 * PER_SECTOR);
+    verify(log);
+    // La tête reprend au début du secteur effacé
+    append(log, 3);
+    CHECK(log.next() == CAPACITY + PER_SECTOR + 3);
+    verify(log);
+
+    FlashLog again(ZONE_ADDRESS, ZONE_SECTORS * SECTOR_SIZE);
+    CHECK(again.init() == 0);
+    CHECK(again.first() == 2 * PER_SECTOR);
+    CHECK(again.next() == CAPACITY + PER_SECTOR + 3);
+    verify(again);
+}
+
+int main()
+{
+    FlashIAP flash;
+    flash.init();
+    checkReboot(flash);
+    checkTornRecord(flash);
+    checkErasedSector(flash);
+    printf("flashLogCheck: %s\n", failures ? "FAILED" : "ok");
+    if (failures == 0) {
+        Sim::power_off();
+    }
+    // Le noyau quitte par _exit() au retour
+    fflush(stdout);
+    return 1;
+}
@@ -0,0 +1,268 @@
+/* Tests du codage des trames Sigfox de la ruche
+ *
+ * Codage puis décodage sur HIVE_SCHEMA : valeurs quantifiées, saturées
+ * ou absentes, trames absolues et différentielles, numéros de trame et
+ * perte d'une trame différentielle. Un message par test en échec,
+ * code de retour non nul s'il y en a.
+ *
+ * Lancé par make check (voir Makefile)
+ */
+
+#include <stdio.h>
+#include <math.h>
+#include "telemetrySchema.hpp"
+
+static int failures = 0;
+
+#define CHECK(cond) check((cond), #cond, __LINE__)
+
+static void check(bool ok, const char *what, int line)
+{
+    if (!ok) {
+        printf("telemetryCheck:%d: %s\n", line, what);
+        failures++;
+    }
+}
+
+// Même valeur à la résolution du champ près, ou absente des deux côtés
+static bool same(const TelemetryField &f, float expected, float decoded)
+{
+    if (isnan(expected) || isnan(decoded)) {
+        return isnan(expected) && isnan(decoded);
+    }
+    return fabsf(expected - decoded) <= f.resolution / 2 + 1e-3f;
+}
+
+static bool delta(const uint8_t frame[])
+{
+    return (frame[0] & 0x80) != 0;
+}
+
+static int seq(const uint8_t frame[])
+{
+    return (frame[0] >> 4) & 7;
+}
+
+// Mesures typiques d'un cycle, qui varient peu de l'un à l'autre
+static void hive(float values[], int n)
+{
+    values[HIVE_TEMP_EXT]    = 12.0f + 0.5f * (n % 3);
+    values[HIVE_TEMP_INT]    = 34.5f;
+    values[HIVE_HUM_EXT]     = 80.0f - (n % 4);
+    values[HIVE_HUM_INT]     = 61.0f;
+    values[HIVE_PROBE_LEFT]  = 33.1f + 0.1f * (n % 2);
+    values[HIVE_PROBE_RIGHT] = 34.2f;
+    values[HIVE_WEIGHT]      = 40100.0f + 20.0f * (n % 2);
+    values[HIVE_PEAK_FREQ]   = 248.0f;
+    values[HIVE_PEAK_LEVEL]  = 81.0f;
+    values[HIVE_RMS_LEVEL]   = 38.0f;
+    values[HIVE_CENTROID]    = 288.0f;
+}
+
+// Code values, décode la trame et compare champ par champ
+static int roundTrip(TelemetryCodec &tx, TelemetryCodec &rx, const float values[],
+                     uint8_t frame[], float decoded[])
+{
+    int len = tx.encode(values, frame);
+    CHECK(len > 0 && len <= TELEMETRY_FRAME_MAX);
+    int err = rx.decode(frame, len, decoded);
+    CHECK(err == TelemetryCodec::TELEMETRY_OK);
+    for (int i = 0; i < HIVE_FIELDS_NR; i++) {
+        if (!same(HIVE_SCHEMA[i], values[i], decoded[i])) {
+            printf("telemetryCheck: %s %g -> %g\n", HIVE_SCHEMA[i].name, values[i], decoded[i]);
+            failures++;
+        }
+    }
+    return len;
+}
+
+static void checkSaturation()
+{
+    TelemetryCodec tx(HIVE_SCHEMA, HIVE_FIELDS_NR);
+    TelemetryCodec rx(HIVE_SCHEMA, HIVE_FIELDS_NR);
+    float values[HIVE_FIELDS_NR];
+    float decoded[HIVE_FIELDS_NR];
+    uint8_t frame[TELEMETRY_FRAME_MAX];
+
+    // Hors plage : bornes du champ, le code tous bits à 1 restant l'absence
+    hive(values, 0);
+    values[HIVE_TEMP_EXT] = -40.0f;
+    values[HIVE_TEMP_INT] = 150.0f;
+    values[HIVE_WEIGHT] = 200000.0f;
+    values[HIVE_PEAK_LEVEL] = -3.0f;
+    tx.encode(values, frame);
+    CHECK(rx.decode(frame, TELEMETRY_FRAME_MAX, decoded) == TelemetryCodec::TELEMETRY_OK);
+    CHECK(decoded[HIVE_TEMP_EXT] == -20.0f);
+    CHECK(decoded[HIVE_TEMP_INT] == -20.0f + 254 * 0.5f);
+    CHECK(decoded[HIVE_WEIGHT] == 8190 * 20.0f);
+    CHECK(decoded[HIVE_PEAK_LEVEL] == 0.0f);
+    CHECK(!isnan(decoded[HIVE_TEMP_INT]) && !isnan(decoded[HIVE_WEIGHT]));
+}
+
+static void checkAbsent()
+{
+    TelemetryCodec tx(HIVE_SCHEMA, HIVE_FIELDS_NR);
+    TelemetryCodec rx(HIVE_SCHEMA, HIVE_FIELDS_NR);
+    float values[HIVE_FIELDS_NR];
+    float decoded[HIVE_FIELDS_NR];
+    uint8_t frame[TELEMETRY_FRAME_MAX];
+
+    // Absents dans une trame absolue puis dans une différentielle
+    hive(values, 0);
+    values[HIVE_HUM_EXT] = NAN;
+    values[HIVE_PROBE_RIGHT] = NAN;
+    roundTrip(tx, rx, values, frame, decoded);
+    CHECK(!delta(frame));
+    hive(values, 1);
+    values[HIVE_HUM_EXT] = NAN;
+    values[HIVE_PROBE_RIGHT] = NAN;
+    roundTrip(tx, rx, values, frame, decoded);
+    CHECK(delta(frame));
+
+    // Capteur revenu : pas de référence, trame absolue
+    hive(values, 2);
+    values[HIVE_PROBE_RIGHT] = NAN;
+    roundTrip(tx, rx, values, frame, decoded);
+    CHECK(!delta(frame));
+
+    // Capteur débranché : absent codé en différentiel
+    hive(values, 3);
+    values[HIVE_TEMP_INT] = NAN;
+    values[HIVE_PROBE_RIGHT] = NAN;
+    roundTrip(tx, rx, values, frame, decoded);
+    CHECK(delta(frame));
+
+    // Rien de mesuré
+    for (int i = 0; i < HIVE_FIELDS_NR; i++) {
+        values[i] = NAN;
+    }
+    roundTrip(tx, rx, values, frame, decoded);
+}
+
+static void checkKeyframe()
+{
+    TelemetryCodec tx(HIVE_SCHEMA, HIVE_FIELDS_NR);
+    TelemetryCodec rx(HIVE_SCHEMA, HIVE_FIELDS_NR);
+    float values[HIVE_FIELDS_NR];
+    float decoded[HIVE_FIELDS_NR];
+    uint8_t frame[TELEMETRY_FRAME_MAX];
+
+    hive(values, 0);
+    roundTrip(tx, rx, values, frame, decoded);
+    hive(values, 1);
+    CHECK(roundTrip(tx, rx, values, frame, decoded) < TELEMETRY_FRAME_MAX);
+    CHECK(delta(frame));
+
+    // Essaimage : l'écart de poids ne tient pas sur 6 bits, trame absolue
+    hive(values, 2);
+    values[HIVE_WEIGHT] -= 2000.0f;
+    CHECK(roundTrip(tx, rx, values, frame, decoded) == TELEMETRY_FRAME_MAX);
+    CHECK(!delta(frame));
+    CHECK(seq(frame) == 2);
+
+    // Puis de nouveau des différentielles depuis cette référence
+    hive(values, 3);
+    values[HIVE_WEIGHT] -= 2000.0f;
+    roundTrip(tx, rx, values, frame, decoded);
+    CHECK(delta(frame));
+    CHECK(seq(frame) == 3);
+}
+
+static void checkSequence()
+{
+    TelemetryCodec tx(HIVE_SCHEMA, HIVE_FIELDS_NR);
+    TelemetryCodec rx(HIVE_SCHEMA, HIVE_FIELDS_NR);
+    float values[HIVE_FIELDS_NR];
+    float decoded[HIVE_FIELDS_NR];
+    uint8_t frame[TELEMETRY_FRAME_MAX];
+
+    // Numéro sur 3 bits : retour à 0 après 7, trame absolue à chaque tour
+    for (int n = 0; n < 2 * TELEMETRY_KEYFRAME + 1; n++) {
+        hive(values, n);
+        roundTrip(tx, rx, values, frame, decoded);
+        CHECK(seq(frame) == n % 8);
+        CHECK(delta(frame) == (n % TELEMETRY_KEYFRAME != 0));
+    }
+
+    // État sauvegardé hors tension : la suite reste différentielle
+    TelemetryState saved = tx.state();
+    TelemetryCodec restored(HIVE_SCHEMA, HIVE_FIELDS_NR);
+    restored.restore(saved);
+    hive(values, 17);
+    roundTrip(restored, rx, values, frame, decoded);
+    CHECK(delta(frame));
+}
+
+static void checkLostFrame()
+{
+    TelemetryCodec tx(HIVE_SCHEMA, HIVE_FIELDS_NR);
+    TelemetryCodec rx(HIVE_SCHEMA, HIVE_FIELDS_NR);
+    float values[HIVE_FIELDS_NR];
+    float decoded[HIVE_FIELDS_NR];
+    uint8_t frame[TELEMETRY_FRAME_MAX];
+
+    hive(values, 0);
+    roundTrip(tx, rx, values, frame, decoded);
+    // Trame différentielle perdue en route
+    hive(values, 1);
+    tx.encode(values, frame);
+    CHECK(delta(frame));
+
+    // Les suivantes sont rejetées jusqu'à la prochaine trame absolue
+    int n;
+    for (n = 2; n < TELEMETRY_KEYFRAME; n++) {
+        hive(values, n);
+        int len = tx.encode(values, frame);
+        CHECK(delta(frame));
+        CHECK(rx.decode(frame, len, decoded) == TelemetryCodec::TELEMETRY_SEQUENCE);
+    }
+    hive(values, n);
+    roundTrip(tx, rx, values, frame, decoded);
+    CHECK(!delta(frame));
+
+    // Différentielle sans aucune trame reçue avant
+    TelemetryCodec late(HIVE_SCHEMA, HIVE_FIELDS_NR);
+    hive(values, n + 1);
+    int len = tx.encode(values, frame);
+    CHECK(late.decode(frame, len, decoded) == TelemetryCodec::TELEMETRY_SEQUENCE);
+
+    // Trame tronquée
+    CHECK(rx.decode(frame, 2, decoded) == TelemetryCodec::TELEMETRY_SHORT);
+}
+
+static void checkBatch()
+{
+    TelemetryCodec codec(HISTORY_SCHEMA, HISTORY_FIELDS_NR);
+    int samples = codec.batchSamples();
+    float values[TELEMETRY_FRAME_MAX * HISTORY_FIELDS_NR];
+    float decoded[TELEMETRY_FRAME_MAX * HISTORY_FIELDS_NR];
+    uint8_t frame[TELEMETRY_FRAME_MAX];
+    uint8_t first = 0;
+
+    CHECK(samples == 3);
+    for (int k = 0; k < samples; k++) {
+        values[k*HISTORY_FIELDS_NR + HISTORY_WEIGHT]     = 40000.0f + 100.0f * k;
+        values[k*HISTORY_FIELDS_NR + HISTORY_TEMP_INT]   = 34.5f;
+        values[k*HISTORY_FIELDS_NR + HISTORY_PEAK_LEVEL] = (k == 1) ? NAN : 80.0f;
+    }
+    int len = codec.encodeBatch(253, values, frame);
+    CHECK(len == TELEMETRY_FRAME_MAX);
+    CHECK(TelemetryCodec::isBatch(frame, len));
+    CHECK(codec.decodeBatch(frame, len, first, decoded) == samples);
+    CHECK(first == 253);
+    for (int i = 0; i < samples * HISTORY_FIELDS_NR; i++) {
+        CHECK(same(HISTORY_SCHEMA[i % HISTORY_FIELDS_NR], values[i], decoded[i]));
+    }
+}
+
+int main()
+{
+    checkSaturation();
+    checkAbsent();
+    checkKeyframe();
+    checkSequence();
+    checkLostFrame();
+    checkBatch();
+    printf("telemetryCheck: %s\n", failures ? "FAILED" : "ok");
+    return failures ? 1 : 0;
+}
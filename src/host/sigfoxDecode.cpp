@@ -0,0 +1,139 @@
+/* Décodeur des trames Sigfox de la ruche, côté serveur
+ *
+ * Lit les charges utiles en hexadécimal (une par ligne, dans l'ordre de
+ * réception) sur l'entrée standard et écrit une ligne CSV par trame.
+ * Les trames différentielles ne peuvent être décodées qu'à la suite de
+ * la précédente : une trame perdue rend les suivantes illisibles jusqu'à
+ * la prochaine trame absolue.
+ *
+ * Les trames d'historique donnent une ligne par mesure, de statut
+ * history:<numéro> (8 bits de poids faible du numéro dans le journal),
+ * seuls les champs de HISTORY_SCHEMA étant remplis.
+ *
+ * Les trames de profil donnent une ligne de statut profile:<cycles>
+ * suivie de la charge moyenne par cycle de chaque phase, en µC.
+ *
+ * Les commandes du modem (AT$SF=<hex>), telles que les écrit la
+ * simulation hôte, sont aussi acceptées.
+ *
+ * Compilation : make sigfoxDecode (voir Makefile), ou
+ *   g++ -std=c++11 -I../tst sigfoxDecode.cpp ../tst/telemetry.cpp -o sigfoxDecode
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include "telemetrySchema.hpp"
+
+// Convertit une chaîne hexadécimale, retourne le nombre d'octets ou -1
+static int parseHex(const char *text, uint8_t frame[], int size)
+{
+    int len = 0;
+    int nibbles = 0;
+    uint8_t byte = 0;
+    for (const char *c = text; *c != '\0' && *c != '\n' && *c != '\r'; c++) {
+        int v;
+        if (*c >= '0' && *c <= '9') {
+            v = *c - '0';
+        } else if (*c >= 'a' && *c <= 'f') {
+            v = *c - 'a' + 10;
+        } else if (*c >= 'A' && *c <= 'F') {
+            v = *c - 'A' + 10;
+        } else {
+            return -1;
+        }
+        byte = (byte << 4) | v;
+        if (++nibbles == 2) {
+            if (len >= size) {
+                return -1;
+            }
+            frame[len++] = byte;
+            nibbles = 0;
+            byte = 0;
+        }
+    }
+    return (nibbles == 0) ? len : -1;
+}
+
+// Ligne CSV : statut, suivi du numéro s'il est positif, puis les valeurs
+static void printValues(const char *status, int seq, const float values[])
+{
+    printf("%s", status);
+    if (seq >= 0) {
+        printf("%d", seq);
+    }
+    for (int i = 0; i < HIVE_FIELDS_NR; i++) {
+        if (isnan(values[i])) {
+            printf(",");
+        } else {
+            printf(",%g", values[i]);
+        }
+    }
+    printf("\n");
+}
+
+int main()
+{
+    TelemetryCodec codec(HIVE_SCHEMA, HIVE_FIELDS_NR);
+    TelemetryCodec history(HISTORY_SCHEMA, HISTORY_FIELDS_NR);
+    // Champ de HIVE_SCHEMA de chaque champ de HISTORY_SCHEMA
+    static const int historyField[HISTORY_FIELDS_NR] = {
+        HIVE_WEIGHT, HIVE_TEMP_INT, HIVE_PEAK_LEVEL
+    };
+    char line[128];
+
+    printf("status");
+    for (int i = 0; i < HIVE_FIELDS_NR; i++) {
+        printf(",%s", HIVE_SCHEMA[i].name);
+    }
+    printf("\n");
+
+    while (fgets(line, sizeof(line), stdin) != NULL) {
+        uint8_t frame[TELEMETRY_FRAME_MAX];
+        float values[HIVE_FIELDS_NR];
+        const char *payload = line;
+        if (strncmp(payload, "AT$SF=", 6) == 0) {
+            payload += 6;
+        }
+        int len = parseHex(payload, frame, sizeof(frame));
+        if (len <= 0) {
+            printf("invalid\n");
+            continue;
+        }
+        if (TelemetryCodec::isProfile(frame, len)) {
+            float charge[TELEMETRY_PROFILE_PHASES];
+            uint8_t cycles;
+            TelemetryCodec::decodeProfile(frame, len, cycles, charge);
+            printf("profile:%d", cycles);
+            for (int i = 0; i < HIVE_PHASES_NR; i++) {
+                if (!isnan(charge[i])) {
+                    printf(",%s=%.3g", HIVE_PHASE_NAMES[i], charge[i]);
+                }
+            }
+            printf("\n");
+            continue;
+        }
+        if (TelemetryCodec::isBatch(frame, len)) {
+            float batch[TELEMETRY_FRAME_MAX * 8];
+            uint8_t first;
+            int samples = history.decodeBatch(frame, len, first, batch);
+            for (int n = 0; n < samples; n++) {
+                for (int i = 0; i < HIVE_FIELDS_NR; i++) {
+                    values[i] = NAN;
+                }
+                for (int i = 0; i < HISTORY_FIELDS_NR; i++) {
+                    values[historyField[i]] = batch[n * HISTORY_FIELDS_NR + i];
+                }
+                printValues("history:", (uint8_t)(first + n), values);
+            }
+            continue;
+        }
+        int err = codec.decode(frame, len, values);
+        if (err != TelemetryCodec::TELEMETRY_OK) {
+            printf("%s\n", (err == TelemetryCodec::TELEMETRY_SEQUENCE) ? "missing" : "short");
+            continue;
+        }
+        printValues("ok", -1, values);
+    }
+    return 0;
+}
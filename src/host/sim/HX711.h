@@ -0,0 +1,22 @@
+#ifndef HX711_H
+#define HX711_H
+#include "mbed.h"
+
+/* HX711 simulé : masse du script, cellule montée à l'envers comme
+ * sur la ruche. Première conversion 400 ms après powerUp() */
+
+class HX711
+{
+public:
+    HX711(PinName pinData, PinName pinSck, uint8_t gain = 128);
+    bool isReady(void);
+    float getGram(uint8_t times = 2);
+    void powerDown();
+    void powerUp();
+
+private:
+    bool _powered;
+    uint64_t _poweredAt;
+};
+
+#endif
@@ -0,0 +1,4 @@
+#ifndef __SIM_LOW_POWER_TICKER_H__
+#define __SIM_LOW_POWER_TICKER_H__
+#include "mbed.h"
+#endif
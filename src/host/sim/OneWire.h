@@ -0,0 +1,36 @@
+#ifndef OneWire_h
+#define OneWire_h
+#include "mbed.h"
+
+/* OneWire à la broche simulé : chaque slot prend sa durée en temps
+ * virtuel et passe au modèle du bus des sondes (Sim::onewire_slot) */
+
+class OneWire
+{
+public:
+    OneWire(PinName pin, int sample_point_us = 13);
+
+    // 1 si au moins une sonde répond
+    uint8_t reset(void);
+    void select(const uint8_t rom[8]);
+    void skip(void);
+    void write_byte(uint8_t v, uint8_t power = 0);
+    void write_bytes(const uint8_t *buf, uint16_t count, bool power = 0);
+    uint8_t read_byte(void);
+    void read_bytes(uint8_t *buf, uint16_t count);
+    void write_bit(uint8_t v);
+    uint8_t read_bit(void);
+    void depower(void) {}
+
+    void reset_search(void);
+    void target_search(uint8_t family_code);
+    uint8_t search(uint8_t *newAddr);
+
+    static uint8_t crc8(const uint8_t *addr, uint8_t len);
+
+private:
+    int _search;                // prochaine sonde de la recherche
+    uint8_t _family;
+};
+
+#endif
@@ -0,0 +1,13 @@
+#ifndef __SIM_KVSTORE_GLOBAL_API_H__
+#define __SIM_KVSTORE_GLOBAL_API_H__
+#include <stddef.h>
+#include <stdint.h>
+
+/* KVStore simulé : une clé "/kv/nom" par fichier kv_nom du répertoire
+ * d'état, conservé entre deux mises sous tension */
+
+int kv_set(const char *full_name_key, const void *buffer, size_t size, uint32_t create_flags);
+int kv_get(const char *full_name_key, void *buffer, size_t buffer_size, size_t *actual_size);
+int kv_remove(const char *full_name_key);
+
+#endif
@@ -0,0 +1,468 @@
+#ifndef __SIM_MBED_H__
+#define __SIM_MBED_H__
+
+/* API mbed-os simulée pour la compilation hôte de l'application
+ *
+ * Seul le sous-ensemble utilisé par src/tst est fourni, avec la même
+ * sémantique vue de l'application. Le temps est celui du noyau de
+ * simulation (sim.hpp).
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <assert.h>
+#include <functional>
+#include <limits>
+#include <list>
+#include "sim.hpp"
+
+// Comme mbed.h
+using namespace std;
+
+#define MBED_ASSERT(expr) assert(expr)
+#define MBED_SUCCESS 0
+#define EVENTS_EVENT_SIZE 64
+
+// Broches de la NUCLEO_L432KC utilisées par l'application
+typedef enum {
+    D0, D1, D2, D3, D4, D5, D6, D7, D8, D9, D10, D11, D12, D13,
+    A0, A1, A2, A3, A4, A5, A6, A7,
+    USBTX, USBRX,
+    ADC_TEMP, ADC_VREF, ADC_VBAT,
+    NC = -1
+} PinName;
+
+typedef enum {
+    PIN_INPUT,
+    PIN_OUTPUT
+} PinDirection;
+
+typedef enum {
+    PullNone,
+    PullUp,
+    PullDown,
+    OpenDrainPullUp,
+    OpenDrainNoPull,
+    OpenDrainPullDown,
+    PullDefault = PullNone,
+    OpenDrain = OpenDrainPullUp
+} PinMode;
+
+// Intrinsèques Cortex-M
+static inline uint32_t __clz(uint32_t x)
+{
+    return x ? __builtin_clz(x) : 32;
+}
+#define __CLZ __clz
+
+static inline uint32_t __rbit(uint32_t x)
+{
+    uint32_t r = 0;
+    for (int i = 0; i < 32; i++, x >>= 1) {
+        r = (r << 1) | (x & 1);
+    }
+    return r;
+}
+#define __RBIT __rbit
+
+// Valeur d'étalonnage de VREFINT, en flash système sur la cible
+extern const uint16_t sim_vrefint_cal;
+#define VREFINT_CAL_ADDR (&sim_vrefint_cal)
+#define VREFINT_CAL_VREF 3000UL
+
+// Fin du programme en flash : la moitié basse des 256 Ko simulés
+#define FLASHIAP_APP_ROM_END_ADDR 0x08020000UL
+
+// Types HAL des membres privés d'AdcDma et de OneWireUart
+typedef struct { int unused; } ADC_HandleTypeDef;
+typedef struct { int unused; } DMA_HandleTypeDef;
+typedef struct { int unused; } TIM_HandleTypeDef;
+typedef struct { int unused; } UART_HandleTypeDef;
+typedef struct { int unused; } ADC_ChannelConfTypeDef;
+
+// Message, puis arrêt du programme
+void error(const char *format, ...);
+
+// Attente active : le temps virtuel avance, les interruptions passent
+void wait_us(int us);
+void wait_ms(int ms);
+
+// ~~~~~~ Callback ~~~~~~~
+
+template <typename F>
+class Callback;
+
+template <typename R, typename... A>
+class Callback<R(A...)>
+{
+public:
+    Callback() {}
+    Callback(R (*f)(A...))
+    {
+        if (f) {
+            _f = f;
+        }
+    }
+    template <typename T, typename U>
+    Callback(U *obj, R (T::*method)(A...))
+        : _f([obj, method](A... a) { return (obj->*method)(a...); }) {}
+    template <typename T, typename U>
+    Callback(const U *obj, R (T::*method)(A...) const)
+        : _f([obj, method](A... a) { return (obj->*method)(a...); }) {}
+
+    R call(A... a) const { return _f(a...); }
+    R operator()(A... a) const { return _f(a...); }
+    operator bool() const { return (bool)_f; }
+
+private:
+    std::function<R(A...)> _f;
+};
+
+template <typename R, typename... A>
+Callback<R(A...)> callback(R (*f)(A...))
+{
+    return Callback<R(A...)>(f);
+}
+
+template <typename T, typename U, typename R, typename... A>
+Callback<R(A...)> callback(U *obj, R (T::*method)(A...))
+{
+    return Callback<R(A...)>(obj, method);
+}
+
+template <typename T, typename U, typename R, typename... A>
+Callback<R(A...)> callback(const U *obj, R (T::*method)(A...) const)
+{
+    return Callback<R(A...)>(obj, method);
+}
+
+// ~~~~~~ Sommeil ~~~~~~~
+
+static inline void sleep_manager_lock_deep_sleep(void)
+{
+    Sim::deep_sleep_lock();
+}
+
+static inline void sleep_manager_unlock_deep_sleep(void)
+{
+    Sim::deep_sleep_unlock();
+}
+
+class DeepSleepLock
+{
+public:
+    DeepSleepLock() { Sim::deep_sleep_lock(); }
+    ~DeepSleepLock() { Sim::deep_sleep_unlock(); }
+};
+
+// Un seul fil d'exécution : rien à masquer
+class CriticalSectionLock
+{
+public:
+    CriticalSectionLock() {}
+};
+
+// ~~~~~~ Entrées-sorties ~~~~~~~
+
+class DigitalOut
+{
+public:
+    DigitalOut(PinName pin, int value = 0);
+    void write(int value);
+    int read(void) const { return _value; }
+    DigitalOut &operator=(int value)
+    {
+        write(value);
+        return *this;
+    }
+    operator int() const { return _value; }
+
+private:
+    PinName _pin;
+    int _value;
+};
+
+/* Broche bidirectionnelle : en sortie à 0, elle tire la ligne ; à 1 ou
+ * en entrée, elle la relâche (collecteur ouvert, seul mode simulé) */
+class DigitalInOut
+{
+public:
+    DigitalInOut(PinName pin, PinDirection direction = PIN_INPUT,
+                 PinMode mode = PullDefault, int value = 0)
+        : _pin(pin), _output(direction == PIN_OUTPUT), _value(value)
+    {
+        drive();
+    }
+    void write(int value)
+    {
+        _value = value;
+        drive();
+    }
+    int read(void) { return Sim::line_level(_pin); }
+    void output(void)
+    {
+        _output = true;
+        drive();
+    }
+    void input(void)
+    {
+        _output = false;
+        drive();
+    }
+    void mode(PinMode pull) {}
+    DigitalInOut &operator=(int value)
+    {
+        write(value);
+        return *this;
+    }
+    operator int() { return read(); }
+
+private:
+    PinName _pin;
+    bool _output;
+    int _value;
+
+    void drive(void) { Sim::line_drive(_pin, true, _output && !_value); }
+};
+
+// Fronts descendants seulement
+class InterruptIn
+{
+public:
+    InterruptIn(PinName pin) : _pin(pin), _enabled(true)
+    {
+        Sim::line_on_fall(_pin, [this]() {
+            if (_enabled && _fall) {
+                _fall();
+            }
+        });
+    }
+    ~InterruptIn() { Sim::line_on_fall(_pin, NULL); }
+    void fall(Callback<void()> func) { _fall = func; }
+    int read(void) { return Sim::line_level(_pin); }
+    void enable_irq(void) { _enabled = true; }
+    void disable_irq(void) { _enabled = false; }
+
+private:
+    PinName _pin;
+    bool _enabled;
+    Callback<void()> _fall;
+};
+
+class AnalogIn
+{
+public:
+    AnalogIn(PinName pin);
+    float read(void);
+    unsigned short read_u16(void);
+    operator float() { return read(); }
+
+private:
+    PinName _pin;
+};
+
+/* UART : USBTX vers la sortie standard, les autres vers le fichier du
+ * modem. Chaque octet prend sa durée d'émission en temps virtuel */
+class Serial
+{
+public:
+    Serial(PinName tx, PinName rx, int baud = 9600);
+    void baud(int baudrate) { _baud = baudrate; }
+    int printf(const char *format, ...) __attribute__((format(printf, 2, 3)));
+    int putc(int c);
+
+private:
+    PinName _tx;
+    int _baud;
+};
+
+// ~~~~~~ Temps ~~~~~~~
+
+// Tickers HAL : us et lp suivent tous deux le temps virtuel
+typedef struct { int unused; } ticker_data_t;
+static inline const ticker_data_t *get_us_ticker_data(void)
+{
+    static const ticker_data_t us_ticker = { 0 };
+    return &us_ticker;
+}
+static inline const ticker_data_t *get_lp_ticker_data(void)
+{
+    static const ticker_data_t lp_ticker = { 1 };
+    return &lp_ticker;
+}
+static inline uint64_t ticker_read_us(const ticker_data_t *ticker)
+{
+    return Sim::now_us();
+}
+static inline uint32_t us_ticker_read(void)
+{
+    return (uint32_t)Sim::now_us();
+}
+
+class Timer
+{
+public:
+    Timer(bool lock_deep_sleep = true)
+        : _lock(lock_deep_sleep), _running(false), _start(0), _acc(0) {}
+    ~Timer() { stop(); }
+    void start(void)
+    {
+        if (!_running) {
+            if (_lock) {
+                Sim::deep_sleep_lock();
+            }
+            _start = Sim::now_us();
+            _running = true;
+        }
+    }
+    void stop(void)
+    {
+        if (_running) {
+            _acc += Sim::now_us() - _start;
+            _running = false;
+            if (_lock) {
+                Sim::deep_sleep_unlock();
+            }
+        }
+    }
+    void reset(void)
+    {
+        _start = Sim::now_us();
+        _acc = 0;
+    }
+    uint64_t read_high_resolution_us(void) const
+    {
+        return _acc + (_running ? Sim::now_us() - _start : 0);
+    }
+    int read_us(void) const { return (int)read_high_resolution_us(); }
+    int read_ms(void) const { return (int)(read_high_resolution_us() / 1000); }
+    float read(void) const { return read_high_resolution_us() / 1e6f; }
+
+private:
+    bool _lock;
+    bool _running;
+    uint64_t _start;
+    uint64_t _acc;
+};
+
+// Compte aussi en deepsleep
+class LowPowerTimer : public Timer
+{
+public:
+    LowPowerTimer() : Timer(false) {}
+};
+
+class Ticker
+{
+public:
+    Ticker() : _irq(0), _period_us(0) {}
+    ~Ticker() { detach(); }
+    void attach(Callback<void()> func, float t) { attach_us(func, (uint64_t)(t * 1e6f)); }
+    void attach_us(Callback<void()> func, uint64_t t);
+    void detach(void);
+
+private:
+    Callback<void()> _func;
+    int _irq;
+    uint64_t _period_us;
+
+    void tick(void);
+};
+
+class LowPowerTicker : public Ticker
+{
+};
+
+// Une seule échéance
+class Timeout
+{
+public:
+    Timeout() : _irq(0) {}
+    ~Timeout() { detach(); }
+    void attach(Callback<void()> func, float t) { attach_us(func, (uint64_t)(t * 1e6f)); }
+    void attach_us(Callback<void()> func, uint64_t t);
+    void detach(void);
+
+private:
+    Callback<void()> _func;
+    int _irq;
+};
+
+class LowPowerTimeout : public Timeout
+{
+};
+
+// ~~~~~~ EventQueue ~~~~~~~
+
+class EventQueue
+{
+public:
+    EventQueue(unsigned size = 32 * EVENTS_EVENT_SIZE) : _last_id(0), _break(false) {}
+
+    template <typename F>
+    int call(F f)
+    {
+        return post(0, std::function<void()>(f));
+    }
+    template <typename T, typename R, typename... A, typename... B>
+    int call(T *obj, R (T::*method)(A...), B... b)
+    {
+        return post(0, [=]() { (obj->*method)(b...); });
+    }
+    template <typename F>
+    int call_in(int ms, F f)
+    {
+        return post(ms, std::function<void()>(f));
+    }
+    template <typename T, typename R, typename... A, typename... B>
+    int call_in(int ms, T *obj, R (T::*method)(A...), B... b)
+    {
+        return post(ms, [=]() { (obj->*method)(b...); });
+    }
+
+    bool cancel(int id);
+    // Exécute les événements pendant ms (toujours si -1) ou jusqu'à break_dispatch()
+    void dispatch(int ms = -1);
+    void dispatch_forever(void) { dispatch(-1); }
+    void break_dispatch(void) { _break = true; }
+
+private:
+    struct Event {
+        uint64_t time;
+        int id;
+        std::function<void()> f;
+    };
+    std::list<Event> _events;      // par échéance croissante
+    int _last_id;
+    bool _break;
+
+    int post(int ms, std::function<void()> f);
+};
+
+// ~~~~~~ Flash interne ~~~~~~~
+
+// 256 Ko en secteurs de 2 Ko, doubles mots de 8 octets, sauvegardés
+// dans le répertoire d'état entre deux mises sous tension
+class FlashIAP
+{
+public:
+    int init(void) { return 0; }
+    int deinit(void) { return 0; }
+    int read(void *buffer, uint32_t addr, uint32_t size);
+    int program(const void *buffer, uint32_t addr, uint32_t size);
+    int erase(uint32_t addr, uint32_t size);
+    uint32_t get_page_size(void) const { return 8; }
+    uint32_t get_sector_size(uint32_t addr) const { return 2048; }
+    uint32_t get_flash_start(void) const { return 0x08000000UL; }
+    uint32_t get_flash_size(void) const { return 256 * 1024; }
+    uint8_t get_erase_value(void) const { return 0xFF; }
+};
+
+#include "rtos.h"
+
+#endif
@@ -0,0 +1,40 @@
+#ifndef __SIM_MBED_ATOMIC_H__
+#define __SIM_MBED_ATOMIC_H__
+#include <stdint.h>
+
+/* Accès atomiques de mbed-os sur les builtins du compilateur hôte
+ * Seules les variantes 16 bits utilisées par l'application */
+
+typedef enum mbed_memory_order {
+    mbed_memory_order_relaxed = __ATOMIC_RELAXED,
+    mbed_memory_order_consume = __ATOMIC_CONSUME,
+    mbed_memory_order_acquire = __ATOMIC_ACQUIRE,
+    mbed_memory_order_release = __ATOMIC_RELEASE,
+    mbed_memory_order_acq_rel = __ATOMIC_ACQ_REL,
+    mbed_memory_order_seq_cst = __ATOMIC_SEQ_CST
+} mbed_memory_order;
+
+static inline uint16_t core_util_atomic_load_u16(const volatile uint16_t *valuePtr)
+{
+    return __atomic_load_n(valuePtr, __ATOMIC_SEQ_CST);
+}
+
+static inline uint16_t core_util_atomic_load_explicit_u16(const volatile uint16_t *valuePtr,
+                                                          mbed_memory_order order)
+{
+    return __atomic_load_n(valuePtr, order);
+}
+
+static inline void core_util_atomic_store_u16(volatile uint16_t *valuePtr, uint16_t desiredValue)
+{
+    __atomic_store_n(valuePtr, desiredValue, __ATOMIC_SEQ_CST);
+}
+
+static inline void core_util_atomic_store_explicit_u16(volatile uint16_t *valuePtr,
+                                                       uint16_t desiredValue,
+                                                       mbed_memory_order order)
+{
+    __atomic_store_n(valuePtr, desiredValue, order);
+}
+
+#endif
@@ -0,0 +1,35 @@
+#ifndef __SIM_RTOS_H__
+#define __SIM_RTOS_H__
+#include "mbed.h"
+
+/* RTOS simulé : un seul thread, les attentes font avancer le temps
+ * virtuel et exécutent les interruptions échues */
+
+namespace ThisThread {
+void sleep_for(uint32_t ms);
+}
+
+class EventFlags
+{
+public:
+    EventFlags() : _flags(0) {}
+    uint32_t set(uint32_t flags)
+    {
+        _flags |= flags;
+        return _flags;
+    }
+    uint32_t clear(uint32_t flags = 0x7fffffff)
+    {
+        uint32_t old = _flags;
+        _flags &= ~flags;
+        return old;
+    }
+    uint32_t get(void) const { return _flags; }
+    // Attend l'un des drapeaux, puis les efface
+    uint32_t wait_any(uint32_t flags, uint32_t millisec = 0xFFFFFFFFU, bool clear = true);
+
+private:
+    volatile uint32_t _flags;
+};
+
+#endif
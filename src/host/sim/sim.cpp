@@ -0,0 +1,305 @@
+/* Simulation hôte de l'application de la ruche
+ *
+ * Chaque mise sous tension par le TPL5110 est un processus fils neuf :
+ * la RAM est perdue comme sur la carte, seuls la flash, le KVStore et
+ * l'horloge sont conservés dans le répertoire d'état.
+ *
+ * Usage : hiveSim [-n cycles] [-s capteurs.csv] [-a son.wav]
+ *                 [-u modem.txt] [-d état] [-t période_s] [-e epoch]
+ *                 [-p] [-k]
+ *   -p  pas de TPL5110 : un seul processus, réveil par l'alarme RTC
+ *   -k  reprend l'état existant au lieu de repartir d'une flash vierge
+ *
+ * Une ligne par cycle sur la sortie standard : numéro, heure simulée,
+ * durée éveillée en temps virtuel et temps CPU réel du cycle.
+ */
+
+#include "mbed.h"
+#include "WakeUp.h"
+#include <map>
+#include <string>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// Point d'entrée de main.cpp, renommé à la compilation
+int app_main(void);
+
+namespace Sim {
+
+static Config _config = {
+    "hiveSim.state", NULL, NULL, "modem.txt", 360, 0, false
+};
+
+// Interruptions en attente, par échéance puis ordre de programmation
+static std::map<std::pair<uint64_t, int>, std::function<void()> > _irqs;
+static int _lastIrq = 0;
+static uint64_t _now = 0;
+static int _deepSleepLocks = 0;
+
+// Horloge et compteur de cycles persistants
+static double _bootClock = 0;
+static uint32_t _cycle = 0;
+static uint32_t _cycles = 10;
+static uint64_t _wakeUs = 0;
+static double _cpuMark = 0;
+
+const Config &config()
+{
+    return _config;
+}
+
+uint64_t now_us()
+{
+    return _now;
+}
+
+double clock_s()
+{
+    return _bootClock + _now / 1e6;
+}
+
+int at(uint64_t time_us, std::function<void()> isr)
+{
+    int id = ++_lastIrq;
+    _irqs[std::make_pair(time_us, id)] = isr;
+    return id;
+}
+
+void cancel(int id)
+{
+    for (auto it = _irqs.begin(); it != _irqs.end(); ++it) {
+        if (it->first.second == id) {
+            _irqs.erase(it);
+            return;
+        }
+    }
+}
+
+uint64_t next()
+{
+    return _irqs.empty() ? UINT64_MAX : _irqs.begin()->first.first;
+}
+
+void advance_to(uint64_t time_us)
+{
+    while (!_irqs.empty() && _irqs.begin()->first.first <= time_us) {
+        auto it = _irqs.begin();
+        std::function<void()> isr = it->second;
+        if (it->first.first > _now) {
+            _now = it->first.first;
+        }
+        _irqs.erase(it);
+        isr();
+    }
+    if (time_us > _now) {
+        _now = time_us;
+    }
+}
+
+bool step()
+{
+    if (_irqs.empty()) {
+        return false;
+    }
+    advance_to(next());
+    return true;
+}
+
+void deep_sleep_lock()
+{
+    _deepSleepLocks++;
+}
+
+void deep_sleep_unlock()
+{
+    MBED_ASSERT(_deepSleepLocks > 0);
+    _deepSleepLocks--;
+}
+
+bool deep_sleep_locked()
+{
+    return _deepSleepLocks > 0;
+}
+
+static std::string statePath(const char *name)
+{
+    return std::string(_config.state_dir) + "/" + name;
+}
+
+static double cpuMs()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+void saveFlash(void);
+void loadFlash(void);
+
+static void saveClock(double clock)
+{
+    FILE *f = fopen(statePath("clock").c_str(), "w");
+    if (f) {
+        fprintf(f, "%u %.6f\n", _cycle, clock);
+        fclose(f);
+    }
+}
+
+static void loadClock()
+{
+    FILE *f = fopen(statePath("clock").c_str(), "r");
+    if (f) {
+        if (fscanf(f, "%u %lf", &_cycle, &_bootClock) != 2) {
+            _cycle = 0;
+            _bootClock = 0;
+        }
+        fclose(f);
+    }
+}
+
+// Fin d'un cycle de mesure : statistiques
+static void cycleEnd()
+{
+    double cpu = cpuMs();
+    printf("cycle %u t=%.0fs awake=%.3fs cpu=%.2fms\n", _cycle, clock_s(),
+           (_now - _wakeUs) / 1e6, cpu - _cpuMark);
+    fflush(stdout);
+    _cycle++;
+    _cpuMark = cpu;
+}
+
+void power_off()
+{
+    if (_config.keep_power) {
+        return;
+    }
+    cycleEnd();
+    saveFlash();
+    // Prochain réveil une période du TPL5110 après celui-ci
+    saveClock(_bootClock + _config.tpl_period_s);
+    fflush(NULL);
+    _exit(0);
+}
+
+// Mise en sommeil par PowerCycle : compte les cycles sans TPL5110
+static void rtcSleep()
+{
+    cycleEnd();
+    if (_cycle >= _cycles) {
+        saveFlash();
+        saveClock(clock_s());
+        fflush(NULL);
+        _exit(0);
+    }
+}
+
+static void usage()
+{
+    fprintf(stderr, "usage: hiveSim [-n cycles] [-s capteurs.csv] [-a son.wav] [-u modem.txt]\n"
+                    "               [-d etat] [-t periode_s] [-e epoch] [-p] [-k]\n");
+    exit(2);
+}
+
+}
+
+// ~~~~~~ WakeUp : alarme RTC ~~~~~~~
+
+Callback<void()> WakeUp::callback;
+float WakeUp::cycles_per_ms = 1.0f;
+static int wakeIrq = 0;
+
+void WakeUp::set_ms(uint32_t ms)
+{
+    if (wakeIrq) {
+        Sim::cancel(wakeIrq);
+        wakeIrq = 0;
+    }
+    if (ms == 0) {
+        return;
+    }
+    Sim::rtcSleep();
+    wakeIrq = Sim::at(Sim::now_us() + (uint64_t)ms * 1000, []() {
+        wakeIrq = 0;
+        Sim::_wakeUs = Sim::now_us();
+        if (WakeUp::callback) {
+            WakeUp::callback.call();
+        }
+    });
+}
+
+void WakeUp::calibrate()
+{
+}
+
+int main(int argc, char *argv[])
+{
+    using namespace Sim;
+    bool keep = false;
+    int opt;
+    while ((opt = getopt(argc, argv, "n:s:a:u:d:t:e:pk")) != -1) {
+        switch (opt) {
+        case 'n': _cycles = strtoul(optarg, NULL, 0); break;
+        case 's': _config.script = optarg; break;
+        case 'a': _config.audio = optarg; break;
+        case 'u': _config.uplink = optarg; break;
+        case 'd': _config.state_dir = optarg; break;
+        case 't': _config.tpl_period_s = strtoul(optarg, NULL, 0); break;
+        case 'e': _config.epoch = strtoul(optarg, NULL, 0); break;
+        case 'p': _config.keep_power = true; break;
+        case 'k': keep = true; break;
+        default: usage();
+        }
+    }
+
+    mkdir(_config.state_dir, 0755);
+    if (!keep) {
+        // Flash vierge, KVStore vide
+        DIR *dir = opendir(_config.state_dir);
+        if (dir == NULL) {
+            error("cannot open %s\n", _config.state_dir);
+        }
+        while (struct dirent *entry = readdir(dir)) {
+            if (entry->d_name[0] != '.') {
+                unlink(statePath(entry->d_name).c_str());
+            }
+        }
+        closedir(dir);
+        FILE *f = fopen(_config.uplink, "w");
+        if (f) {
+            fclose(f);
+        }
+    }
+
+    // Un processus par mise sous tension, un seul sans TPL5110
+    loadClock();
+    uint32_t last = _cycle + _cycles;
+    while (_cycle < last) {
+        // Les objets globaux sont construits : le fils démarre comme la carte
+        fflush(stdout);
+        pid_t pid = fork();
+        if (pid < 0) {
+            error("fork\n");
+        }
+        if (pid == 0) {
+            loadClock();
+            _cycles = last;
+            _cpuMark = cpuMs();
+            loadFlash();
+            app_main();
+            _exit(1);
+        }
+        int status;
+        waitpid(pid, &status, 0);
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            fprintf(stderr, "hiveSim: cycle %u failed\n", _cycle);
+            return 1;
+        }
+        loadClock();
+        if (_config.keep_power) {
+            break;
+        }
+    }
+    return 0;
+}
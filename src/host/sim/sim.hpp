@@ -0,0 +1,88 @@
+#ifndef __SIM_HPP__
+#define __SIM_HPP__
+#include <stdint.h>
+#include <functional>
+
+/* Noyau de la simulation hôte
+ *
+ * Le temps est virtuel : il n'avance que dans les attentes (wait_us,
+ * sleep_for, dispatch, wait_any), qui exécutent au passage les
+ * interruptions simulées (trames ADC, alarme RTC) dans l'ordre de leur
+ * échéance. Le calcul ne consomme pas de temps virtuel : le temps CPU
+ * réel de chaque cycle est mesuré à part.
+ */
+
+namespace Sim {
+
+// Temps virtuel depuis la mise sous tension, en µs
+uint64_t now_us(void);
+
+/** Programme une interruption
+ * @return identifiant non nul
+ */
+int at(uint64_t time_us, std::function<void()> isr);
+void cancel(int id);
+// Échéance de la prochaine interruption, UINT64_MAX si aucune
+uint64_t next(void);
+
+// Avance jusqu'à time_us en exécutant les interruptions échues
+void advance_to(uint64_t time_us);
+// Avance jusqu'à la prochaine interruption et l'exécute, false si aucune
+bool step(void);
+
+// Verrous du deepsleep, pour les statistiques de sommeil
+void deep_sleep_lock(void);
+void deep_sleep_unlock(void);
+bool deep_sleep_locked(void);
+
+// Sortie DONE du TPL5110 : fin du cycle, l'alimentation est coupée
+void power_off(void);
+
+/* Déclenchement de l'ADC1 : logiciel après la construction d'un
+ * AnalogIn (HAL_ADC_Init), TIM6 après AdcDma::start(), qui le laisse
+ * en place. Un AnalogIn lu sur TIM6 attend en vain sa conversion */
+void adc1_software_trigger(bool software);
+
+// ~~~~~~ Lignes à collecteur ouvert (simPeripherals.cpp) ~~~~~~~
+/* Ligne tirée à 1, à 0 dès que l'hôte (DigitalInOut) ou le modèle du
+ * périphérique la tire. Les broches sont les PinName de mbed.h */
+void line_drive(int pin, bool host, bool low);
+int line_level(int pin);
+// Front descendant, pour InterruptIn
+void line_on_fall(int pin, std::function<void()> isr);
+// Commande de l'hôte, pour le modèle du périphérique
+void line_on_host(int pin, std::function<void(bool low)> device);
+
+// ~~~~~~ Configuration (sim.cpp) ~~~~~~~
+struct Config {
+    const char *state_dir;      // flash, KVStore et horloge persistants
+    const char *script;         // mesures des capteurs, CSV
+    const char *audio;          // son du micro, WAV PCM 16 bits mono
+    const char *uplink;         // octets émis sur l'UART du modem
+    uint32_t tpl_period_s;      // période du TPL5110
+    uint32_t epoch;             // heure RTC au démarrage, 0 si non réglée
+    bool keep_power;            // pas de TPL5110 : réveil par l'alarme RTC
+};
+const Config &config(void);
+
+// Temps écoulé depuis le début de la simulation (tous cycles), en s
+double clock_s(void);
+
+// ~~~~~~ Capteurs scriptés (simSensors.cpp) ~~~~~~~
+enum Channel {
+    TEMP_INT, HUM_INT, TEMP_EXT, HUM_EXT, WEIGHT, PROBE0, PROBE1, BATTERY,
+    CHANNELS_NR
+};
+// Valeur d'un canal à l'instant courant, NaN si absent du script
+float sensor(Channel c);
+// Échantillon sonore n à la fréquence fs, en pleine échelle [-1, 1]
+float audio(uint64_t n, uint32_t fs);
+
+/* Bus 1-Wire des sondes DS18B20, sans notion de durée
+ * Un slot : l'hôte écrit bit, ou lit avec bit à 1 ; niveau de la ligne */
+bool onewire_reset(void);
+int onewire_slot(int bit);
+
+}
+
+#endif
@@ -0,0 +1,89 @@
+/* AdcDma simulé : les moitiés du tampon ping-pong sont remplies avec le
+ * son de Sim::audio() à la cadence du DMA, en interruption simulée */
+
+#include "adcDma.hpp"
+
+AdcDma *AdcDma::_instance = NULL;
+
+// Instance unique : état du "DMA" hors de la classe
+static uint32_t adc_fs = 0;
+static int dma_irq = 0;
+static uint8_t dma_half = 0;
+
+AdcDma::AdcDma(PinName pin, uint16_t *buffer, uint16_t frame_len, uint32_t fs,
+               uint16_t oversampling)
+    : _buffer(buffer), _frame_len(frame_len), _running(false)
+{
+    MBED_ASSERT(_instance == NULL);
+    _instance = this;
+    adc_fs = fs;
+}
+
+AdcDma::~AdcDma()
+{
+    stop();
+    _instance = NULL;
+}
+
+void AdcDma::attach(FrameCallback cb)
+{
+    _callback = cb;
+}
+
+bool AdcDma::start()
+{
+    if (_running) {
+        return true;
+    }
+    sleep_manager_lock_deep_sleep();
+    _running = true;
+    // configureAdc() : déclenchement par TIM6, laissé par stop()
+    Sim::adc1_software_trigger(false);
+    dma_half = 0;
+    uint64_t frame_us = (uint64_t)_frame_len * 1000000 / adc_fs;
+    dma_irq = Sim::at(Sim::now_us() + frame_us, dmaIrq);
+    return true;
+}
+
+void AdcDma::stop()
+{
+    if (!_running) {
+        return;
+    }
+    Sim::cancel(dma_irq);
+    dma_irq = 0;
+    _running = false;
+    sleep_manager_unlock_deep_sleep();
+}
+
+bool AdcDma::running() const
+{
+    return _running;
+}
+
+void AdcDma::frameReady(uint8_t half)
+{
+    if (_callback) {
+        _callback(_buffer + half * _frame_len, _frame_len);
+    }
+}
+
+// Moitié pleine : programme la suivante avant le callback, qui peut arrêter
+void AdcDma::dmaIrq()
+{
+    AdcDma *adc = _instance;
+    uint64_t now = Sim::now_us();
+    uint64_t frame_us = (uint64_t)adc->_frame_len * 1000000 / adc_fs;
+    uint64_t first = (now - frame_us) * adc_fs / 1000000;
+    uint16_t *dst = adc->_buffer + dma_half * adc->_frame_len;
+    for (int n = 0; n < adc->_frame_len; n++) {
+        float v = Sim::audio(first + n, adc_fs);
+        v = (v > 1) ? 1 : (v < -1) ? -1 : v;
+        dst[n] = (uint16_t)(2048 + 2047 * v);
+    }
+
+    uint8_t half = dma_half;
+    dma_half ^= 1;
+    dma_irq = Sim::at(now + frame_us, dmaIrq);
+    adc->frameReady(half);
+}
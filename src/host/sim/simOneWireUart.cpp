@@ -0,0 +1,36 @@
+/* Transport de OneWireUart simulé : chaque trame prend sa durée
+ * d'émission en temps virtuel, son écho est le niveau de la ligne
+ * donné par le modèle du bus des sondes */
+
+#include "oneWireUart.hpp"
+
+OneWireUart *OneWireUart::_instance = NULL;
+
+OneWireUart::OneWireUart(PinName tx)
+{
+    MBED_ASSERT(_instance == NULL);
+    _instance = this;
+    reset_search();
+}
+
+OneWireUart::~OneWireUart()
+{
+    _instance = NULL;
+}
+
+bool OneWireUart::transfer(uint8_t frames[], uint16_t n, uint32_t baud)
+{
+    // Le coeur dort pendant le DMA, l'USART interdit le deepsleep
+    DeepSleepLock lock;
+    int frame_us = 10000000 / baud;
+    for (uint16_t i = 0; i < n; i++) {
+        wait_us(frame_us);
+        if (baud < 20000) {
+            // Reset : présence pendant les bits de poids fort
+            frames[i] = Sim::onewire_reset() ? 0xE0 : frames[i];
+        } else {
+            frames[i] = Sim::onewire_slot(frames[i] == 0xFF) ? 0xFF : 0x00;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,438 @@
+/* Périphériques mbed simulés : attentes, EventQueue, GPIO, ADC, UART,
+ * flash interne et KVStore
+ *
+ * Les attentes font avancer le temps virtuel du noyau (sim.cpp) et
+ * exécutent les interruptions échues au passage.
+ */
+
+#include "mbed.h"
+#include "kvstore_global_api.h"
+#include <stdarg.h>
+#include <map>
+#include <string>
+#include <unistd.h>
+
+// Erreur du KVStore pour une clé absente
+#define SIM_KV_NOT_FOUND (-0x107)
+
+// Étalonnage d'usine typique de VREFINT (1,212 V sous 3 V)
+const uint16_t sim_vrefint_cal = 1655;
+
+void error(const char *format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    vfprintf(stderr, format, args);
+    va_end(args);
+    fflush(NULL);
+    _exit(1);
+}
+
+void wait_us(int us)
+{
+    Sim::advance_to(Sim::now_us() + us);
+}
+
+void wait_ms(int ms)
+{
+    Sim::advance_to(Sim::now_us() + (uint64_t)ms * 1000);
+}
+
+void ThisThread::sleep_for(uint32_t ms)
+{
+    Sim::advance_to(Sim::now_us() + (uint64_t)ms * 1000);
+}
+
+// Heure RTC : perdue à chaque coupure du TPL5110 si elle n'est pas réglée
+extern "C" time_t time(time_t *t) __THROW
+{
+    const Sim::Config &config = Sim::config();
+    time_t now = config.epoch ? (time_t)(config.epoch + Sim::clock_s())
+                              : (time_t)(Sim::now_us() / 1000000);
+    if (t) {
+        *t = now;
+    }
+    return now;
+}
+
+// ~~~~~~ EventFlags ~~~~~~~
+
+uint32_t EventFlags::wait_any(uint32_t flags, uint32_t millisec, bool clear)
+{
+    uint64_t deadline = (millisec == 0xFFFFFFFFU) ? UINT64_MAX
+                        : Sim::now_us() + (uint64_t)millisec * 1000;
+    while (!(_flags & flags)) {
+        if (Sim::next() > deadline) {
+            Sim::advance_to(deadline);
+            return 0xFFFFFFFEU;         // osFlagsErrorTimeout
+        }
+        if (!Sim::step()) {
+            error("EventFlags::wait_any: no interrupt pending\n");
+        }
+    }
+    uint32_t value = _flags;
+    if (clear) {
+        _flags &= ~flags;
+    }
+    return value;
+}
+
+// ~~~~~~ EventQueue ~~~~~~~
+
+int EventQueue::post(int ms, std::function<void()> f)
+{
+    Event event = { Sim::now_us() + (uint64_t)ms * 1000, ++_last_id, f };
+    // Après les événements de même échéance
+    auto it = _events.begin();
+    while (it != _events.end() && it->time <= event.time) {
+        ++it;
+    }
+    _events.insert(it, event);
+    return event.id;
+}
+
+bool EventQueue::cancel(int id)
+{
+    for (auto it = _events.begin(); it != _events.end(); ++it) {
+        if (it->id == id) {
+            _events.erase(it);
+            return true;
+        }
+    }
+    return false;
+}
+
+void EventQueue::dispatch(int ms)
+{
+    uint64_t deadline = (ms < 0) ? UINT64_MAX : Sim::now_us() + (uint64_t)ms * 1000;
+    _break = false;
+    while (!_break) {
+        if (!_events.empty() && _events.front().time <= Sim::now_us()) {
+            std::function<void()> f = _events.front().f;
+            _events.pop_front();
+            f();
+            continue;
+        }
+        uint64_t target = _events.empty() ? deadline : std::min(_events.front().time, deadline);
+        // Une interruption peut poster un événement plus tôt
+        if (Sim::next() < target) {
+            Sim::step();
+            continue;
+        }
+        if (target == UINT64_MAX) {
+            error("EventQueue::dispatch: nothing to wait for\n");
+        }
+        Sim::advance_to(target);
+        if (target == deadline && (_events.empty() || _events.front().time > deadline)) {
+            return;
+        }
+    }
+}
+
+// ~~~~~~ Entrées-sorties ~~~~~~~
+
+DigitalOut::DigitalOut(PinName pin, int value) : _pin(pin), _value(value)
+{
+}
+
+void DigitalOut::write(int value)
+{
+    bool rising = value && !_value;
+    _value = value;
+    // DONE du TPL5110
+    if (_pin == D5 && rising) {
+        Sim::power_off();
+    }
+}
+
+namespace Sim {
+
+struct Line {
+    bool host_low;
+    bool device_low;
+    std::function<void()> fall;
+    std::function<void(bool)> device;
+};
+
+// Construites à la demande : les objets globaux s'y inscrivent
+static std::map<int, Line> &lines()
+{
+    static std::map<int, Line> map;
+    return map;
+}
+
+void line_drive(int pin, bool host, bool low)
+{
+    Line &line = lines()[pin];
+    bool was_low = line.host_low || line.device_low;
+    bool host_was_low = line.host_low;
+    (host ? line.host_low : line.device_low) = low;
+    if (host && low != host_was_low && line.device) {
+        line.device(low);
+    }
+    if (!was_low && (line.host_low || line.device_low) && line.fall) {
+        line.fall();
+    }
+}
+
+int line_level(int pin)
+{
+    const Line &line = lines()[pin];
+    return !(line.host_low || line.device_low);
+}
+
+void line_on_fall(int pin, std::function<void()> isr)
+{
+    lines()[pin].fall = isr;
+}
+
+void line_on_host(int pin, std::function<void(bool)> device)
+{
+    lines()[pin].device = device;
+}
+
+}
+
+// Déclenchement logiciel de l'ADC1, réglé par le dernier init
+static bool adc1_software = true;
+
+void Sim::adc1_software_trigger(bool software)
+{
+    adc1_software = software;
+}
+
+AnalogIn::AnalogIn(PinName pin) : _pin(pin)
+{
+    // analogin_init() : HAL_ADC_Init sans déclenchement externe
+    Sim::adc1_software_trigger(true);
+}
+
+float AnalogIn::read()
+{
+    return read_u16() / 65535.0f;
+}
+
+unsigned short AnalogIn::read_u16()
+{
+    // Conversion attendue de TIM6 : HAL_ADC_PollForConversion expire
+    if (!adc1_software) {
+        wait_us(10000);
+        return 0;
+    }
+    if (_pin != ADC_VREF) {
+        return 0;
+    }
+    // VREFINT vu par l'ADC, alimenté par la pile
+    float vdd = Sim::sensor(Sim::BATTERY);
+    if (!(vdd > 0)) {
+        vdd = 3.0f;
+    }
+    float raw = sim_vrefint_cal * (VREFINT_CAL_VREF / 1000.0f) / vdd;
+    if (raw > 4095) {
+        raw = 4095;
+    }
+    return (unsigned short)raw << 4;
+}
+
+Serial::Serial(PinName tx, PinName rx, int baud) : _tx(tx), _baud(baud)
+{
+}
+
+int Serial::printf(const char *format, ...)
+{
+    char buffer[256];
+    va_list args;
+    va_start(args, format);
+    int len = vsnprintf(buffer, sizeof(buffer), format, args);
+    va_end(args);
+    if (len > (int)sizeof(buffer) - 1) {
+        len = sizeof(buffer) - 1;
+    }
+    for (int i = 0; i < len; i++) {
+        putc(buffer[i]);
+    }
+    return len;
+}
+
+int Serial::putc(int c)
+{
+    static FILE *uplink = NULL;
+    FILE *f = stdout;
+    if (_tx != USBTX) {
+        if (uplink == NULL) {
+            uplink = fopen(Sim::config().uplink, "a");
+            if (uplink == NULL) {
+                error("cannot open %s\n", Sim::config().uplink);
+            }
+        }
+        f = uplink;
+    }
+    fputc(c, f);
+    // 8N1 : 10 bits par octet
+    Sim::advance_to(Sim::now_us() + 10000000ULL / _baud);
+    return c;
+}
+
+// ~~~~~~ Ticker ~~~~~~~
+
+void Ticker::attach_us(Callback<void()> func, uint64_t t)
+{
+    detach();
+    _func = func;
+    _period_us = t;
+    _irq = Sim::at(Sim::now_us() + t, [this]() { tick(); });
+}
+
+void Ticker::detach()
+{
+    if (_irq) {
+        Sim::cancel(_irq);
+        _irq = 0;
+    }
+}
+
+void Ticker::tick()
+{
+    _irq = Sim::at(Sim::now_us() + _period_us, [this]() { tick(); });
+    _func();
+}
+
+void Timeout::attach_us(Callback<void()> func, uint64_t t)
+{
+    detach();
+    _func = func;
+    _irq = Sim::at(Sim::now_us() + t, [this]() {
+        _irq = 0;
+        _func();
+    });
+}
+
+void Timeout::detach()
+{
+    if (_irq) {
+        Sim::cancel(_irq);
+        _irq = 0;
+    }
+}
+
+// ~~~~~~ Flash interne ~~~~~~~
+
+#define SIM_FLASH_START 0x08000000UL
+#define SIM_FLASH_SIZE (256 * 1024)
+
+static uint8_t flash[SIM_FLASH_SIZE];
+
+static bool flashRange(uint32_t addr, uint32_t size)
+{
+    return addr >= SIM_FLASH_START && size <= SIM_FLASH_SIZE
+           && addr - SIM_FLASH_START <= SIM_FLASH_SIZE - size;
+}
+
+int FlashIAP::read(void *buffer, uint32_t addr, uint32_t size)
+{
+    if (!flashRange(addr, size)) {
+        return -1;
+    }
+    memcpy(buffer, flash + (addr - SIM_FLASH_START), size);
+    return 0;
+}
+
+int FlashIAP::program(const void *buffer, uint32_t addr, uint32_t size)
+{
+    if (!flashRange(addr, size) || addr % 8 || size % 8) {
+        return -1;
+    }
+    uint8_t *dst = flash + (addr - SIM_FLASH_START);
+    // Double mot déjà écrit : PROGERR sur la cible
+    for (uint32_t i = 0; i < size; i++) {
+        if (dst[i] != 0xFF) {
+            fprintf(stderr, "FlashIAP::program: 0x%08lx not erased\n",
+                    (unsigned long)(addr + i));
+            return -1;
+        }
+    }
+    memcpy(dst, buffer, size);
+    // 8 octets en ~90 µs
+    Sim::advance_to(Sim::now_us() + size / 8 * 90);
+    return 0;
+}
+
+int FlashIAP::erase(uint32_t addr, uint32_t size)
+{
+    if (!flashRange(addr, size) || addr % 2048 || size % 2048) {
+        return -1;
+    }
+    memset(flash + (addr - SIM_FLASH_START), 0xFF, size);
+    // 22 ms par secteur
+    Sim::advance_to(Sim::now_us() + size / 2048 * 22000);
+    return 0;
+}
+
+namespace Sim {
+
+static std::string statePath(const std::string &name)
+{
+    return std::string(config().state_dir) + "/" + name;
+}
+
+void saveFlash()
+{
+    FILE *f = fopen(statePath("flash.bin").c_str(), "wb");
+    if (f == NULL || fwrite(flash, 1, sizeof(flash), f) != sizeof(flash)) {
+        error("cannot save flash.bin\n");
+    }
+    fclose(f);
+}
+
+void loadFlash()
+{
+    memset(flash, 0xFF, sizeof(flash));
+    FILE *f = fopen(statePath("flash.bin").c_str(), "rb");
+    if (f) {
+        if (fread(flash, 1, sizeof(flash), f) != sizeof(flash)) {
+            memset(flash, 0xFF, sizeof(flash));
+        }
+        fclose(f);
+    }
+}
+
+}
+
+// ~~~~~~ KVStore ~~~~~~~
+
+// "/kv/nom" -> répertoire d'état/kv_nom
+static std::string kvPath(const char *key)
+{
+    const char *name = strrchr(key, '/');
+    return std::string(Sim::config().state_dir) + "/kv_" + (name ? name + 1 : key);
+}
+
+int kv_set(const char *full_name_key, const void *buffer, size_t size, uint32_t create_flags)
+{
+    FILE *f = fopen(kvPath(full_name_key).c_str(), "wb");
+    if (f == NULL) {
+        return -1;
+    }
+    size_t written = fwrite(buffer, 1, size, f);
+    fclose(f);
+    return (written == size) ? MBED_SUCCESS : -1;
+}
+
+int kv_get(const char *full_name_key, void *buffer, size_t buffer_size, size_t *actual_size)
+{
+    FILE *f = fopen(kvPath(full_name_key).c_str(), "rb");
+    if (f == NULL) {
+        return SIM_KV_NOT_FOUND;
+    }
+    size_t n = fread(buffer, 1, buffer_size, f);
+    fclose(f);
+    if (actual_size) {
+        *actual_size = n;
+    }
+    return MBED_SUCCESS;
+}
+
+int kv_remove(const char *full_name_key)
+{
+    return remove(kvPath(full_name_key).c_str()) == 0 ? MBED_SUCCESS : SIM_KV_NOT_FOUND;
+}
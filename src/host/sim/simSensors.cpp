@@ -0,0 +1,701 @@
+/* Capteurs simulés : mesures scriptées et son du micro
+ *
+ * Script CSV, une ligne d'en-tête puis une ligne par instant, valeurs
+ * interpolées linéairement entre deux lignes :
+ *     time,tempInt,humInt,tempExt,humExt,weight,probe0,probe1,battery
+ *     0,34.5,60,12,80,40000,34.2,33.1,3.0
+ * time en s depuis le début de la simulation, en g et en V. Colonnes
+ * dans un ordre quelconque, absentes ou vides : capteur débranché.
+ * Sans script, des courbes journalières typiques d'une ruche en été.
+ */
+
+#include "mbed.h"
+#include "HX711.h"
+#include "OneWire.h"
+#include <algorithm>
+#include <string>
+#include <vector>
+
+namespace Sim {
+
+static const char *const CHANNEL_NAMES[CHANNELS_NR] = {
+    "tempInt", "humInt", "tempExt", "humExt", "weight", "probe0", "probe1", "battery"
+};
+
+struct Row {
+    double time;
+    float values[CHANNELS_NR];
+};
+static std::vector<Row> script;
+static bool scriptLoaded = false;
+
+static void loadScript()
+{
+    scriptLoaded = true;
+    if (config().script == NULL) {
+        return;
+    }
+    FILE *f = fopen(config().script, "r");
+    if (f == NULL) {
+        error("cannot open %s\n", config().script);
+    }
+
+    // Colonne de chaque canal, -1 pour le temps
+    std::vector<int> columns;
+    char line[512];
+    if (fgets(line, sizeof(line), f)) {
+        for (char *tok = strtok(line, ",\r\n"); tok; tok = strtok(NULL, ",\r\n")) {
+            int c = -2;
+            if (strcmp(tok, "time") == 0) {
+                c = -1;
+            }
+            for (int i = 0; i < CHANNELS_NR; i++) {
+                if (strcmp(tok, CHANNEL_NAMES[i]) == 0) {
+                    c = i;
+                }
+            }
+            columns.push_back(c);
+        }
+    }
+
+    while (fgets(line, sizeof(line), f)) {
+        Row row = { 0 };
+        for (int i = 0; i < CHANNELS_NR; i++) {
+            row.values[i] = NAN;
+        }
+        // Champs vides conservés : pas de strtok
+        char *p = line;
+        for (size_t k = 0; k < columns.size() && p; k++) {
+            char *end = strpbrk(p, ",\r\n");
+            std::string field(p, end ? end - p : strlen(p));
+            if (!field.empty() && columns[k] == -1) {
+                row.time = atof(field.c_str());
+            } else if (!field.empty() && columns[k] >= 0) {
+                row.values[columns[k]] = atof(field.c_str());
+            }
+            p = (end && *end == ',') ? end + 1 : NULL;
+        }
+        script.push_back(row);
+    }
+    fclose(f);
+}
+
+// Heure du jour en fraction de jour, 0 à minuit
+static double dayPhase()
+{
+    double t = config().epoch + clock_s();
+    return fmod(t, 86400) / 86400;
+}
+
+// Courbes par défaut : 15 h plus chaud, 3 h plus froid
+static float defaultValue(Channel c)
+{
+    double day = sin(2 * M_PI * (dayPhase() - 0.375));
+    switch (c) {
+    case TEMP_INT: return 34.5f + 0.3f * day;
+    case HUM_INT:  return 60.0f - 3.0f * day;
+    case TEMP_EXT: return 15.0f + 8.0f * day;
+    case HUM_EXT:  return 70.0f - 20.0f * day;
+    case WEIGHT:   return 40000.0f + 0.005f * clock_s();    // ~430 g/jour de miellée
+    case PROBE0:   return 34.2f + 0.2f * day;
+    case PROBE1:   return 33.1f + 0.4f * day;
+    case BATTERY:  return 3.0f - 2e-7f * clock_s();
+    default:       return NAN;
+    }
+}
+
+float sensor(Channel c)
+{
+    if (!scriptLoaded) {
+        loadScript();
+    }
+    if (script.empty()) {
+        return defaultValue(c);
+    }
+
+    double t = clock_s();
+    if (t <= script.front().time) {
+        return script.front().values[c];
+    }
+    for (size_t i = 1; i < script.size(); i++) {
+        const Row &a = script[i - 1];
+        const Row &b = script[i];
+        if (t <= b.time) {
+            double span = b.time - a.time;
+            double k = (span > 0) ? (t - a.time) / span : 1;
+            return a.values[c] + (float)k * (b.values[c] - a.values[c]);
+        }
+    }
+    return script.back().values[c];
+}
+
+// ~~~~~~ Son ~~~~~~~
+
+static std::vector<int16_t> wav;
+static uint32_t wavRate = 0;
+static bool wavLoaded = false;
+
+static uint32_t le32(const uint8_t *p)
+{
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+// WAV PCM 16 bits mono, lu par blocs RIFF
+static void loadWav()
+{
+    wavLoaded = true;
+    if (config().audio == NULL) {
+        return;
+    }
+    FILE *f = fopen(config().audio, "rb");
+    uint8_t header[12];
+    if (f == NULL || fread(header, 1, 12, f) != 12
+            || memcmp(header, "RIFF", 4) || memcmp(header + 8, "WAVE", 4)) {
+        error("%s: not a WAV file\n", config().audio);
+    }
+    uint8_t chunk[8];
+    while (fread(chunk, 1, 8, f) == 8) {
+        uint32_t size = le32(chunk + 4);
+        if (memcmp(chunk, "fmt ", 4) == 0) {
+            uint8_t fmt[16];
+            if (size < 16 || fread(fmt, 1, 16, f) != 16) {
+                break;
+            }
+            if (fmt[0] != 1 || fmt[2] != 1 || fmt[14] != 16) {
+                error("%s: PCM 16 bits mono only\n", config().audio);
+            }
+            wavRate = le32(fmt + 4);
+            fseek(f, size - 16 + (size & 1), SEEK_CUR);
+        } else if (memcmp(chunk, "data", 4) == 0) {
+            wav.resize(size / 2);
+            size_t n = fread(wav.data(), 2, wav.size(), f);
+            wav.resize(n);
+            break;
+        } else {
+            fseek(f, size + (size & 1), SEEK_CUR);
+        }
+    }
+    fclose(f);
+    if (wav.empty() || wavRate == 0) {
+        error("%s: no audio data\n", config().audio);
+    }
+}
+
+// Bruit blanc reproductible dans [-1, 1]
+static float noise(uint64_t n)
+{
+    uint32_t x = (uint32_t)(n * 2654435761u) ^ (uint32_t)(n >> 32);
+    x ^= x >> 15;
+    x *= 0x2c1b3c6d;
+    x ^= x >> 12;
+    return (int32_t)x / 2147483648.0f;
+}
+
+float audio(uint64_t n, uint32_t fs)
+{
+    if (!wavLoaded) {
+        loadWav();
+    }
+    // Le son continue d'un cycle à l'autre
+    double t = (clock_s() - now_us() / 1e6) + (double)n / fs;
+    if (!wav.empty()) {
+        uint64_t k = (uint64_t)(t * wavRate) % wav.size();
+        return wav[k] / 32768.0f;
+    }
+    // Bourdonnement de la colonie : fondamentale et harmonique
+    return 0.20f * sinf(2 * M_PI * fmod(250 * t, 1.0))
+           + 0.08f * sinf(2 * M_PI * fmod(500 * t, 1.0))
+           + 0.02f * noise(n);
+}
+
+}
+
+// ~~~~~~ DHT22 ~~~~~~~
+
+/* Modèle au niveau de la broche : D3 intérieur, D4 extérieur
+ * Après une impulsion de démarrage de l'hôte, réponse de 80 µs à 0 et
+ * 80 µs à 1, puis 40 bits de 50 µs à 0 et 27 µs (0) ou 70 µs (1) à 1.
+ * Une valeur absente du script ne répond pas, comme un capteur débranché */
+
+#define DHT_START_MIN_US 800
+
+class SimDht
+{
+public:
+    SimDht(PinName pin, Sim::Channel temp, Sim::Channel hum)
+        : _pin(pin), _temp(temp), _hum(hum), _lowSince(0), _busy(false)
+    {
+        Sim::line_on_host(_pin, [this](bool low) { host(low); });
+    }
+
+private:
+    PinName _pin;
+    Sim::Channel _temp;
+    Sim::Channel _hum;
+    uint64_t _lowSince;
+    bool _busy;
+
+    void host(bool low)
+    {
+        uint64_t now = Sim::now_us();
+        if (low) {
+            _lowSince = now;
+            return;
+        }
+        if (_busy || now - _lowSince < DHT_START_MIN_US) {
+            return;
+        }
+        float t = Sim::sensor(_temp);
+        float h = Sim::sensor(_hum);
+        if (isnan(t) || isnan(h)) {
+            return;
+        }
+        // Trame DHT22 : dixièmes, température en signe et valeur absolue
+        uint16_t h10 = (uint16_t)lroundf(h * 10);
+        uint16_t t10 = (uint16_t)lroundf(fabsf(t) * 10) | (t < 0 ? 0x8000 : 0);
+        uint8_t b[5] = { (uint8_t)(h10 >> 8), (uint8_t)h10, (uint8_t)(t10 >> 8), (uint8_t)t10, 0 };
+        b[4] = b[0] + b[1] + b[2] + b[3];
+
+        _busy = true;
+        uint64_t at = now + 30;
+        drive(at, true);
+        drive(at += 80, false);
+        at += 80;
+        for (int i = 0; i < 40; i++) {
+            drive(at, true);
+            drive(at += 50, false);
+            at += ((b[i / 8] >> (7 - i % 8)) & 1) ? 70 : 27;
+        }
+        drive(at, true);
+        at += 50;
+        Sim::at(at, [this]() {
+            Sim::line_drive(_pin, false, false);
+            _busy = false;
+        });
+    }
+
+    void drive(uint64_t at, bool low)
+    {
+        Sim::at(at, [this, low]() { Sim::line_drive(_pin, false, low); });
+    }
+};
+
+static SimDht dhtInterior(D3, Sim::TEMP_INT, Sim::HUM_INT);
+static SimDht dhtExterior(D4, Sim::TEMP_EXT, Sim::HUM_EXT);
+
+// ~~~~~~ HX711 ~~~~~~~
+
+#define HX711_SETTLE_US 400000
+
+HX711::HX711(PinName pinData, PinName pinSck, uint8_t gain)
+    : _powered(false), _poweredAt(0)
+{
+}
+
+bool HX711::isReady()
+{
+    // Cellule débranchée : DOUT reste à 1
+    return _powered && !isnan(Sim::sensor(Sim::WEIGHT))
+           && Sim::now_us() - _poweredAt >= HX711_SETTLE_US;
+}
+
+float HX711::getGram(uint8_t times)
+{
+    // 24 bits lus en ~50 µs, puis attente de chaque conversion suivante à 10 Hz
+    wait_us(50 * times + 100000 * (times - 1));
+    return -Sim::sensor(Sim::WEIGHT);
+}
+
+void HX711::powerDown()
+{
+    _powered = false;
+}
+
+void HX711::powerUp()
+{
+    if (!_powered) {
+        _powered = true;
+        _poweredAt = Sim::now_us();
+    }
+}
+
+// ~~~~~~ Bus 1-Wire / DS1820 ~~~~~~~
+
+/* DS18B20 sur le bus des sondes : sonde i du canal PROBE<i>, numéro de
+ * série i, dans l'ordre de la recherche d'adresses. Modèle au niveau du
+ * slot : l'hôte écrit un bit ou lit (bit à 1), les sondes tirent la
+ * ligne à 0 pour répondre 0.
+ * Conversion de 94 ms en 9 bits à 750 ms en 12 bits, température prise
+ * au lancement. Les sondes repartent de la configuration par défaut à
+ * chaque mise sous tension */
+
+#define DS1820_CONVERT_12BITS_US 750000
+#define DS1820_PROBES (Sim::PROBE1 - Sim::PROBE0 + 1)
+
+static uint8_t crc8(const uint8_t *data, int len)
+{
+    uint8_t crc = 0;
+    while (len--) {
+        uint8_t b = *data++;
+        for (int i = 0; i < 8; i++, b >>= 1) {
+            crc = ((crc ^ b) & 1) ? (crc >> 1) ^ 0x8C : crc >> 1;
+        }
+    }
+    return crc;
+}
+
+class SimOneWire
+{
+public:
+    SimOneWire() : _state(IDLE), _selected(0), _byte(0), _bits(0), _count(0)
+    {
+        // Adresses des sondes de la ruche, droite puis gauche
+        static const uint8_t roms[DS1820_PROBES][7] = {
+            { 0x28, 0x8E, 0x2D, 0x35, 0x0C, 0, 0 },
+            { 0x28, 0x34, 0xAB, 0x33, 0x0C, 0, 0 },
+        };
+        for (int i = 0; i < DS1820_PROBES; i++) {
+            Probe &p = _probes[i];
+            memcpy(p.rom, roms[i], 7);
+            p.rom[7] = crc8(p.rom, 7);
+            // 85 °C à la mise sous tension, 12 bits
+            static const uint8_t pad[8] = { 0x50, 0x05, 0x4B, 0x46, 0x7F, 0xFF, 0x0C, 0x10 };
+            memcpy(p.scratchpad, pad, 8);
+            p.scratchpad[8] = crc8(p.scratchpad, 8);
+            p.convertEnd = 0;
+        }
+    }
+
+    // Sonde de rang n dans l'ordre de la recherche
+    int searchOrder(int n)
+    {
+        int order[DS1820_PROBES];
+        for (int i = 0; i < DS1820_PROBES; i++) {
+            order[i] = i;
+        }
+        std::sort(order, order + DS1820_PROBES, [this](int a, int b) {
+            return before(_probes[a].rom, _probes[b].rom);
+        });
+        return order[n];
+    }
+
+    bool rom(int i, uint8_t out[8])
+    {
+        if (!present(i)) {
+            return false;
+        }
+        memcpy(out, _probes[i].rom, 8);
+        return true;
+    }
+
+    bool reset()
+    {
+        _selected = 0;
+        for (int i = 0; i < DS1820_PROBES; i++) {
+            if (present(i)) {
+                _selected |= 1 << i;
+            }
+        }
+        _state = _selected ? ROM : IDLE;
+        _bits = _count = 0;
+        return _state == ROM;
+    }
+
+    int slot(int bit)
+    {
+        switch (_state) {
+        case SEARCH:
+            return search(bit);
+        case READ:
+            return bit & readBit();
+        case CONVERT:
+            return bit & converted();
+        case IDLE:
+            return bit;
+        default:
+            // Octet écrit par l'hôte, bit de poids faible en tête
+            _byte = (_byte >> 1) | (bit << 7);
+            if (++_bits == 8) {
+                _bits = 0;
+                command(_byte);
+            }
+            return bit;
+        }
+    }
+
+private:
+    enum State { IDLE, ROM, MATCH, SEARCH, FUNCTION, WRITE, READ, CONVERT };
+
+    struct Probe {
+        uint8_t rom[8];
+        uint8_t scratchpad[9];
+        uint64_t convertEnd;
+    };
+
+    Probe _probes[DS1820_PROBES];
+    State _state;
+    uint32_t _selected;         // sondes adressées
+    uint8_t _byte;
+    int _bits;                  // bits de l'octet ou de la recherche
+    int _count;                 // octets de la commande en cours
+    uint8_t _rom[8];
+
+    bool present(int i)
+    {
+        return !isnan(Sim::sensor((Sim::Channel)(Sim::PROBE0 + i)));
+    }
+
+    static int romBit(const uint8_t rom[8], int k)
+    {
+        return (rom[k / 8] >> (k % 8)) & 1;
+    }
+
+    // La recherche prend la branche 0 d'abord, bit 0 de l'adresse en tête
+    static bool before(const uint8_t a[8], const uint8_t b[8])
+    {
+        for (int k = 0; k < 64; k++) {
+            if (romBit(a, k) != romBit(b, k)) {
+                return romBit(a, k) == 0;
+            }
+        }
+        return false;
+    }
+
+    // Triplet : bit, bit complémenté, puis direction choisie par l'hôte
+    int search(int bit)
+    {
+        int k = _bits / 3;
+        int level = 1;
+        for (int i = 0; i < DS1820_PROBES; i++) {
+            if (!(_selected & (1 << i))) {
+                continue;
+            }
+            int b = romBit(_probes[i].rom, k);
+            switch (_bits % 3) {
+            case 0: level &= b; break;
+            case 1: level &= !b; break;
+            default:
+                if (b != bit) {
+                    _selected &= ~(1 << i);
+                }
+            }
+        }
+        if (++_bits == 64 * 3) {
+            _state = _selected ? FUNCTION : IDLE;
+        }
+        return bit & level;
+    }
+
+    int readBit()
+    {
+        for (int i = 0; i < DS1820_PROBES; i++) {
+            if (_selected & (1 << i)) {
+                int b = (_bits < 9 * 8) ? (_probes[i].scratchpad[_bits / 8] >> (_bits % 8)) & 1 : 1;
+                _bits++;
+                return b;
+            }
+        }
+        return 1;
+    }
+
+    int converted()
+    {
+        for (int i = 0; i < DS1820_PROBES; i++) {
+            if ((_selected & (1 << i)) && Sim::now_us() < _probes[i].convertEnd) {
+                return 0;
+            }
+        }
+        return 1;
+    }
+
+    void command(uint8_t v)
+    {
+        switch (_state) {
+        case ROM:
+            if (v == 0xCC) {
+                _state = FUNCTION;
+            } else if (v == 0x55) {
+                _count = 0;
+                _state = MATCH;
+            } else if (v == 0xF0) {
+                _bits = 0;
+                _state = SEARCH;
+            } else {
+                _state = IDLE;
+            }
+            break;
+
+        case MATCH:
+            _rom[_count++] = v;
+            if (_count == 8) {
+                for (int i = 0; i < DS1820_PROBES; i++) {
+                    if (memcmp(_probes[i].rom, _rom, 8) != 0) {
+                        _selected &= ~(1 << i);
+                    }
+                }
+                _state = _selected ? FUNCTION : IDLE;
+            }
+            break;
+
+        case FUNCTION:
+            _count = 0;
+            if (v == 0x44) {
+                convert();
+                _state = CONVERT;
+            } else if (v == 0xBE && (_selected & (_selected - 1)) == 0) {
+                _state = READ;
+            } else if (v == 0x4E) {
+                _state = WRITE;
+            } else {
+                _state = IDLE;
+            }
+            break;
+
+        case WRITE:
+            // TH, TL et configuration, bits 0-4 et 7 de la configuration fixes
+            for (int i = 0; i < DS1820_PROBES; i++) {
+                if (_selected & (1 << i)) {
+                    Probe &p = _probes[i];
+                    p.scratchpad[2 + _count] = (_count == 2) ? ((v & 0x60) | 0x1F) : v;
+                    p.scratchpad[8] = crc8(p.scratchpad, 8);
+                }
+            }
+            if (++_count == 3) {
+                _state = IDLE;
+            }
+            break;
+
+        default:
+            break;
+        }
+    }
+
+    void convert()
+    {
+        for (int i = 0; i < DS1820_PROBES; i++) {
+            if (_selected & (1 << i)) {
+                Probe &p = _probes[i];
+                int bits = 9 + ((p.scratchpad[4] >> 5) & 3);
+                float t = Sim::sensor((Sim::Channel)(Sim::PROBE0 + i));
+                int16_t raw = (int16_t)lroundf(t * 16) & ~((1 << (12 - bits)) - 1);
+                p.scratchpad[0] = (uint8_t)raw;
+                p.scratchpad[1] = (uint8_t)(raw >> 8);
+                p.scratchpad[8] = crc8(p.scratchpad, 8);
+                p.convertEnd = Sim::now_us() + (DS1820_CONVERT_12BITS_US >> (12 - bits));
+            }
+        }
+    }
+};
+
+static SimOneWire probeBus;
+
+bool Sim::onewire_reset()
+{
+    return probeBus.reset();
+}
+
+int Sim::onewire_slot(int bit)
+{
+    return probeBus.slot(bit);
+}
+
+// ~~~~~~ OneWire à la broche ~~~~~~~
+
+#define ONEWIRE_RESET_US 960
+#define ONEWIRE_SLOT_US 70
+// 64 triplets après la commande Search ROM
+#define ONEWIRE_SEARCH_US (ONEWIRE_RESET_US + (8 + 64 * 3) * ONEWIRE_SLOT_US)
+
+OneWire::OneWire(PinName pin, int sample_point_us) : _search(0), _family(0)
+{
+}
+
+uint8_t OneWire::crc8(const uint8_t *addr, uint8_t len)
+{
+    return ::crc8(addr, len);
+}
+
+uint8_t OneWire::reset()
+{
+    wait_us(ONEWIRE_RESET_US);
+    return Sim::onewire_reset();
+}
+
+void OneWire::select(const uint8_t rom[8])
+{
+    write_byte(0x55);
+    write_bytes(rom, 8);
+}
+
+void OneWire::skip()
+{
+    write_byte(0xCC);
+}
+
+void OneWire::write_bytes(const uint8_t *buf, uint16_t count, bool power)
+{
+    for (uint16_t i = 0; i < count; i++) {
+        write_byte(buf[i]);
+    }
+}
+
+void OneWire::write_byte(uint8_t v, uint8_t power)
+{
+    for (int i = 0; i < 8; i++, v >>= 1) {
+        write_bit(v & 1);
+    }
+}
+
+uint8_t OneWire::read_byte()
+{
+    uint8_t v = 0;
+    for (int i = 0; i < 8; i++) {
+        v |= read_bit() << i;
+    }
+    return v;
+}
+
+void OneWire::read_bytes(uint8_t *buf, uint16_t count)
+{
+    for (uint16_t i = 0; i < count; i++) {
+        buf[i] = read_byte();
+    }
+}
+
+void OneWire::write_bit(uint8_t v)
+{
+    wait_us(ONEWIRE_SLOT_US);
+    Sim::onewire_slot(v & 1);
+}
+
+uint8_t OneWire::read_bit()
+{
+    wait_us(ONEWIRE_SLOT_US);
+    return Sim::onewire_slot(1);
+}
+
+void OneWire::reset_search()
+{
+    _search = 0;
+    _family = 0;
+}
+
+void OneWire::target_search(uint8_t family_code)
+{
+    _search = 0;
+    _family = family_code;
+}
+
+// Recherche abrégée : les sondes présentes, dans l'ordre du protocole
+uint8_t OneWire::search(uint8_t *newAddr)
+{
+    wait_us(ONEWIRE_SEARCH_US);
+    Sim::onewire_reset();
+    for (; _search < DS1820_PROBES; _search++) {
+        if (probeBus.rom(probeBus.searchOrder(_search), newAddr) && (_family == 0 || newAddr[0] == _family)) {
+            _search++;
+            return 1;
+        }
+    }
+    return 0;
+}
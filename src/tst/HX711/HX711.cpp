@@ -98,6 +98,12 @@ int HX711::getValue() //Obtenir la valeur brut du controller
     return buffer;
 }
  
+bool HX711::isReady() //Conversion disponible (DOUT à 0), sans attente
+{
+    DigitalIn data(_pinData);
+    return data.read() == 0;
+}
+ 
 void HX711::setOffset(int offset)
 {
     _offset = offset;
@@ -108,9 +114,9 @@ void HX711::setScale(float scale)
     _scale = scale;
 }
  
-float HX711::getGram()
+float HX711::getGram(uint8_t times) //Une conversion par mesure, 100 ms à 10 Hz
 {
-    long val = (averageValue(2) - _offset);
+    long val = (averageValue(times) - _offset);
     return (float) val / _scale;
 }
  
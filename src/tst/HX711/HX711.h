@@ -36,10 +36,11 @@ public:
     HX711(PinName pinData, PinName pinSck,uint8_t gain = 128);
     ~HX711();
     int getValue(void);
+    bool isReady(void);
     int averageValue(uint8_t times);
     void setOffset(int offset);
     void setScale(float scale);
-    float getGram();
+    float getGram(uint8_t times = 2);
     void setGain(uint8_t gain);
     void powerDown();
     void powerUp();
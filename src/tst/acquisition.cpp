@@ -0,0 +1,85 @@
+#include "acquisition.hpp"
+
+Acquisition::Acquisition(EventQueue &queue)
+    : _queue(queue), _count(0), _pending(0)
+{
+}
+
+bool Acquisition::add(Action start, Action collect, int delay_ms,
+                      Condition ready, int poll_ms)
+{
+    if (_count >= MAX_TASKS) {
+        return false;
+    }
+
+    // Tri par délai décroissant : les conversions les plus longues
+    // démarrent en premier
+    int pos = _count;
+    while (pos > 0 && _tasks[pos - 1].delay_ms < delay_ms) {
+        _tasks[pos] = _tasks[pos - 1];
+        pos--;
+    }
+
+    Task &task = _tasks[pos];
+    task.start = start;
+    task.collect = collect;
+    task.ready = ready;
+    task.delay_ms = delay_ms;
+    task.poll_ms = poll_ms;
+    task.event = 0;
+    task.done = false;
+    _count++;
+    return true;
+}
+
+void Acquisition::clear()
+{
+    _count = 0;
+    _pending = 0;
+}
+
+bool Acquisition::run(int timeout_ms)
+{
+    _pending = _count;
+    for (int i = 0; i < _count; i++) {
+        Task &task = _tasks[i];
+        task.done = false;
+        if (task.start) {
+            task.start();
+        }
+        task.event = _queue.call_in(task.delay_ms, this, &Acquisition::check, &task);
+    }
+
+    if (_pending > 0) {
+        // Interrompu par check() au dernier relevé
+        _queue.dispatch(timeout_ms);
+    }
+
+    // Délai dépassé : les tâches restantes sont abandonnées
+    for (int i = 0; i < _count; i++) {
+        if (!_tasks[i].done && _tasks[i].event != 0) {
+            _queue.cancel(_tasks[i].event);
+        }
+    }
+    return _pending == 0;
+}
+
+int Acquisition::pending() const
+{
+    return _pending;
+}
+
+void Acquisition::check(Task *task)
+{
+    if (task->ready && !task->ready()) {
+        task->event = _queue.call_in(task->poll_ms, this, &Acquisition::check, task);
+        return;
+    }
+
+    task->event = 0;
+    task->collect();
+    task->done = true;
+    if (--_pending == 0) {
+        _queue.break_dispatch();
+    }
+}
@@ -0,0 +1,76 @@
+#ifndef __ACQUISITION_HPP__
+#define __ACQUISITION_HPP__
+#include "mbed.h"
+
+/* Ordonnanceur des acquisitions d'un cycle de mesure
+ *
+ * Chaque tâche est lancée (start), puis relevée (collect) quand le
+ * capteur est prêt : après delay_ms, et si une condition ready est
+ * donnée, dès qu'elle est vraie (testée toutes les poll_ms).
+ * Toutes les conversions lentes sont lancées ensemble, le cycle dure
+ * donc autant que le capteur le plus lent et non la somme de tous.
+ *
+ * Les relevés sont exécutés par l'EventQueue dans le thread qui appelle
+ * run(), le coeur dort entre deux événements.
+ *
+ * @code
+ * EventQueue queue(8 * EVENTS_EVENT_SIZE);
+ * Acquisition cycle(queue);
+ *
+ * cycle.add(sondesStart, sondesCollect, 750);
+ * cycle.add(balanceStart, balanceCollect, 0, balancePrete, 20);
+ * cycle.run(2000);
+ * @endcode
+ */
+class Acquisition
+{
+public:
+    typedef Callback<void()> Action;
+    typedef Callback<bool()> Condition;
+
+    // Nombre maximal de tâches par cycle
+    static const int MAX_TASKS = 8;
+
+    Acquisition(EventQueue &queue);
+
+    /** Ajoute une tâche au cycle
+     * @param start lancement de la conversion, peut être vide
+     * @param collect lecture du résultat
+     * @param delay_ms délai minimal entre start et collect
+     * @param ready condition de fin de conversion, testée après delay_ms
+     * @param poll_ms période de test de ready
+     * @return false si le cycle est plein
+     */
+    bool add(Action start, Action collect, int delay_ms,
+             Condition ready = Condition(), int poll_ms = 10);
+    // Retire toutes les tâches
+    void clear(void);
+
+    /** Lance toutes les tâches et attend leurs relevés
+     * @param timeout_ms durée maximale du cycle
+     * @return true si toutes les tâches ont été relevées
+     */
+    bool run(int timeout_ms);
+    // Tâches non relevées au dernier run()
+    int pending(void) const;
+
+private:
+    struct Task {
+        Action start;
+        Action collect;
+        Condition ready;
+        int delay_ms;
+        int poll_ms;
+        int event;
+        bool done;
+    };
+
+    EventQueue &_queue;
+    Task _tasks[MAX_TASKS];
+    int _count;
+    int _pending;
+
+    void check(Task *task);
+};
+
+#endif
@@ -0,0 +1,219 @@
+#if defined(TARGET_STM32L4)
+
+#include "adcDma.hpp"
+#include "pinmap.h"
+#include "PeripheralPins.h"
+
+AdcDma *AdcDma::_instance = NULL;
+
+AdcDma::AdcDma(PinName pin, uint16_t *buffer, uint16_t frame_len, uint32_t fs,
+               uint16_t oversampling)
+    : _buffer(buffer), _frame_len(frame_len), _running(false)
+{
+    // Un seul moteur possible : les périphériques sont fixes
+    MBED_ASSERT(_instance == NULL);
+    MBED_ASSERT(oversampling >= 1 && oversampling <= 256
+                && (oversampling & (oversampling - 1)) == 0);
+    _instance = this;
+
+    // Une conversion par déclenchement, même suréchantillonnée
+    initTimer(fs * oversampling);
+    initDma();
+    initAdc(pin, oversampling);
+}
+
+AdcDma::~AdcDma()
+{
+    stop();
+    NVIC_DisableIRQ(DMA1_Channel1_IRQn);
+    HAL_ADC_DeInit(&_adc);
+    HAL_DMA_DeInit(&_dma);
+    HAL_TIM_Base_DeInit(&_tim);
+    _instance = NULL;
+}
+
+void AdcDma::attach(FrameCallback cb)
+{
+    _callback = cb;
+}
+
+bool AdcDma::start()
+{
+    if (_running) {
+        return true;
+    }
+
+    // Les conversions continuent en sleep mais pas en stop :
+    // on interdit le deepsleep le temps de l'acquisition
+    sleep_manager_lock_deep_sleep();
+    _running = true;
+    configureAdc();
+
+    if (HAL_ADC_Start_DMA(&_adc, (uint32_t *)_buffer, 2 * _frame_len) != HAL_OK) {
+        _running = false;
+        sleep_manager_unlock_deep_sleep();
+        return false;
+    }
+    __HAL_TIM_SET_COUNTER(&_tim, 0);
+    HAL_TIM_Base_Start(&_tim);
+    return true;
+}
+
+void AdcDma::stop()
+{
+    if (!_running) {
+        return;
+    }
+
+    HAL_TIM_Base_Stop(&_tim);
+    HAL_ADC_Stop_DMA(&_adc);
+    _running = false;
+    sleep_manager_unlock_deep_sleep();
+}
+
+bool AdcDma::running() const
+{
+    return _running;
+}
+
+void AdcDma::initTimer(uint32_t fs)
+{
+    // Horloge de TIM6 : PCLK1, doublée si le prescaler APB1 est actif
+    uint32_t clk = HAL_RCC_GetPCLK1Freq();
+    if ((RCC->CFGR & RCC_CFGR_PPRE1) != RCC_CFGR_PPRE1_DIV1) {
+        clk *= 2;
+    }
+
+    // Prescaler minimal pour que la période tienne sur 16 bits
+    uint32_t psc = clk / (fs * 0x10000UL);
+    uint32_t arr = clk / ((psc + 1) * fs) - 1;
+
+    __HAL_RCC_TIM6_CLK_ENABLE();
+    _tim.Instance               = TIM6;
+    _tim.Init.Prescaler         = psc;
+    _tim.Init.CounterMode       = TIM_COUNTERMODE_UP;
+    _tim.Init.Period            = arr;
+    _tim.Init.AutoReloadPreload = TIM_AUTORELOAD_PRELOAD_DISABLE;
+    if (HAL_TIM_Base_Init(&_tim) != HAL_OK) {
+        error("Cannot initialize TIM6\n");
+    }
+
+    // Chaque débordement génère un TRGO qui déclenche une conversion
+    TIM_MasterConfigTypeDef master = {0};
+    master.MasterOutputTrigger = TIM_TRGO_UPDATE;
+    master.MasterSlaveMode     = TIM_MASTERSLAVEMODE_DISABLE;
+    HAL_TIMEx_MasterConfigSynchronization(&_tim, &master);
+}
+
+void AdcDma::initDma()
+{
+    __HAL_RCC_DMA1_CLK_ENABLE();
+    _dma.Instance                 = DMA1_Channel1;
+    _dma.Init.Request             = DMA_REQUEST_0;          // ADC1
+    _dma.Init.Direction           = DMA_PERIPH_TO_MEMORY;
+    _dma.Init.PeriphInc           = DMA_PINC_DISABLE;
+    _dma.Init.MemInc              = DMA_MINC_ENABLE;
+    _dma.Init.PeriphDataAlignment = DMA_PDATAALIGN_HALFWORD;
+    _dma.Init.MemDataAlignment    = DMA_MDATAALIGN_HALFWORD;
+    _dma.Init.Mode                = DMA_CIRCULAR;           // ping-pong
+    _dma.Init.Priority            = DMA_PRIORITY_HIGH;
+    if (HAL_DMA_Init(&_dma) != HAL_OK) {
+        error("Cannot initialize DMA1 channel 1\n");
+    }
+    __HAL_LINKDMA(&_adc, DMA_Handle, _dma);
+
+    NVIC_SetVector(DMA1_Channel1_IRQn, (uint32_t)&AdcDma::dmaIrq);
+    NVIC_EnableIRQ(DMA1_Channel1_IRQn);
+}
+
+void AdcDma::initAdc(PinName pin, uint16_t oversampling)
+{
+    _adc.Instance = (ADC_TypeDef *)pinmap_peripheral(pin, PinMap_ADC);
+    MBED_ASSERT(_adc.Instance == ADC1);
+    uint32_t function = pinmap_function(pin, PinMap_ADC);
+    pinmap_pinout(pin, PinMap_ADC);
+
+    // Même configuration que analogin_device.c, mais déclenchée par TIM6
+    _adc.State = HAL_ADC_STATE_RESET;
+    _adc.Init.ClockPrescaler        = ADC_CLOCK_ASYNC_DIV2;
+    _adc.Init.Resolution            = ADC_RESOLUTION_12B;
+    _adc.Init.DataAlign             = ADC_DATAALIGN_RIGHT;
+    _adc.Init.ScanConvMode          = DISABLE;
+    _adc.Init.EOCSelection          = ADC_EOC_SINGLE_CONV;
+    _adc.Init.LowPowerAutoWait      = DISABLE;
+    _adc.Init.ContinuousConvMode    = DISABLE;
+    _adc.Init.NbrOfConversion       = 1;
+    _adc.Init.DiscontinuousConvMode = DISABLE;
+    _adc.Init.NbrOfDiscConversion   = 1;
+    _adc.Init.ExternalTrigConv      = ADC_EXTERNALTRIG_T6_TRGO;
+    _adc.Init.ExternalTrigConvEdge  = ADC_EXTERNALTRIGCONVEDGE_RISING;
+    _adc.Init.DMAContinuousRequests = ENABLE;       // DMA circulaire
+    _adc.Init.Overrun               = ADC_OVR_DATA_OVERWRITTEN;
+    _adc.Init.OversamplingMode      = (oversampling > 1) ? ENABLE : DISABLE;
+    if (oversampling > 1) {
+        // Somme de 2^shift conversions ramenée sur 12 bits
+        uint32_t shift = 31 - __CLZ(oversampling);
+        _adc.Init.Oversampling.Ratio         = (shift - 1) << ADC_CFGR2_OVSR_Pos;
+        _adc.Init.Oversampling.RightBitShift = shift << ADC_CFGR2_OVSS_Pos;
+        _adc.Init.Oversampling.TriggeredMode = ADC_TRIGGEREDMODE_MULTI_TRIGGER;
+        _adc.Init.Oversampling.OversamplingStopReset = ADC_REGOVERSAMPLING_CONTINUED_MODE;
+    }
+#if defined(ADC_CFGR_DFSDMCFG) && defined(DFSDM1_Channel0)
+    _adc.Init.DFSDMConfig           = 0;
+#endif
+
+    __HAL_RCC_ADC_CLK_ENABLE();
+    __HAL_RCC_ADC_CONFIG(RCC_ADCCLKSOURCE_SYSCLK);
+
+    if (HAL_ADC_Init(&_adc) != HAL_OK) {
+        error("Cannot initialize ADC\n");
+    }
+    if (!HAL_ADCEx_Calibration_GetValue(&_adc, ADC_SINGLE_ENDED)) {
+        HAL_ADCEx_Calibration_Start(&_adc, ADC_SINGLE_ENDED);
+    }
+
+    _channel.Channel      = __LL_ADC_DECIMAL_NB_TO_CHANNEL(STM_PIN_CHANNEL(function));
+    _channel.Rank         = ADC_REGULAR_RANK_1;
+    _channel.SamplingTime = ADC_SAMPLETIME_47CYCLES_5;
+    _channel.SingleDiff   = ADC_SINGLE_ENDED;
+    _channel.OffsetNumber = ADC_OFFSET_NONE;
+    _channel.Offset       = 0;
+    HAL_ADC_ConfigChannel(&_adc, &_channel);
+}
+
+void AdcDma::configureAdc()
+{
+    // Un AnalogIn a pu reprogrammer l'ADC1 depuis la dernière acquisition
+    HAL_ADC_Stop(&_adc);
+    HAL_ADC_Init(&_adc);
+    HAL_ADC_ConfigChannel(&_adc, &_channel);
+}
+
+void AdcDma::frameReady(uint8_t half)
+{
+    if (_callback) {
+        _callback(_buffer + half * _frame_len, _frame_len);
+    }
+}
+
+void AdcDma::dmaIrq()
+{
+    uint32_t isr = DMA1->ISR;
+
+    if (isr & DMA_ISR_TEIF1) {
+        DMA1->IFCR = DMA_IFCR_CTEIF1;
+        _instance->stop();
+        return;
+    }
+    if (isr & DMA_ISR_HTIF1) {
+        DMA1->IFCR = DMA_IFCR_CHTIF1;
+        _instance->frameReady(0);
+    }
+    if (isr & DMA_ISR_TCIF1) {
+        DMA1->IFCR = DMA_IFCR_CTCIF1;
+        _instance->frameReady(1);
+    }
+    DMA1->IFCR = DMA_IFCR_CGIF1;
+}
+
+#endif
@@ -0,0 +1,89 @@
+#ifndef __ADC_DMA_HPP__
+#define __ADC_DMA_HPP__
+#include "mbed.h"
+
+/* Moteur d'acquisition ADC pour STM32L4 (NUCLEO_L432KC)
+ *
+ * TIM6 déclenche chaque conversion de l'ADC1 (TRGO), le DMA1 canal 1
+ * recopie les résultats en mode circulaire dans un tampon ping-pong de
+ * 2*frame_len échantillons 12 bits. À chaque moitié pleine, le callback
+ * reçoit un pointeur sur la trame terminée pendant que l'autre se remplit.
+ *
+ * Aucun travail CPU par échantillon : le coeur peut rester en sommeil
+ * (sleep, pas deepsleep) pendant toute l'acquisition.
+ *
+ * Avec oversampling > 1, TIM6 déclenche oversampling fois plus vite et
+ * le suréchantillonneur matériel de l'ADC moyenne chaque groupe de
+ * conversions successives (mode multi-déclenchement) : c'est un premier
+ * filtre décimateur (moyenne glissante, CIC d'ordre 1) sans coût CPU.
+ *
+ * Le callback est appelé en contexte d'interruption.
+ *
+ * L'ADC1 peut être partagé avec des AnalogIn (tension de la pile, par
+ * exemple) hors acquisition : start() réapplique sa configuration.
+ *
+ * @code
+ * static uint16_t buf[2*256];
+ * AdcDma micro(A0, buf, 256, 4000);
+ *
+ * void trame(const uint16_t *data, uint16_t len) { ... }
+ *
+ * micro.attach(trame);
+ * micro.start();
+ * @endcode
+ */
+class AdcDma
+{
+public:
+    // Trame prête : pointeur sur la moitié pleine du tampon et sa longueur
+    typedef Callback<void(const uint16_t *, uint16_t)> FrameCallback;
+
+    /** Configure ADC1, DMA1 canal 1 et TIM6
+     * @param pin entrée analogique (doit être reliée à l'ADC1)
+     * @param buffer tampon de 2*frame_len échantillons
+     * @param frame_len nombre d'échantillons par demi-tampon
+     * @param fs fréquence des échantillons délivrés en Hz
+     * @param oversampling conversions moyennées par échantillon
+     *        (puissance de 2 de 1 à 256), résultat toujours sur 12 bits
+     */
+    AdcDma(PinName pin, uint16_t *buffer, uint16_t frame_len, uint32_t fs,
+           uint16_t oversampling = 1);
+    ~AdcDma();
+
+    // Associe la fonction appelée à chaque trame prête
+    void attach(FrameCallback cb);
+    // Lance l'acquisition (la trame 0 est remplie en premier)
+    bool start(void);
+    // Arrête l'acquisition, utilisable depuis une interruption
+    void stop(void);
+    // Indique si l'acquisition est en cours
+    bool running(void) const;
+
+private:
+    ADC_HandleTypeDef _adc;
+    DMA_HandleTypeDef _dma;
+    TIM_HandleTypeDef _tim;
+    ADC_ChannelConfTypeDef _channel;
+    uint16_t *_buffer;
+    uint16_t _frame_len;
+    volatile bool _running;
+    FrameCallback _callback;
+
+    // Instance unique : ADC1, DMA1 canal 1 et TIM6 sont fixes
+    static AdcDma *_instance;
+
+    void initTimer(uint32_t fs);
+    void initDma(void);
+    void initAdc(PinName pin, uint16_t oversampling);
+    void configureAdc(void);
+    void frameReady(uint8_t half);
+
+    // Interruption DMA1 canal 1 : demi-transfert et transfert complet
+    static void dmaIrq(void);
+
+    // disallow copy constructor and assignment operator
+    AdcDma(const AdcDma &);
+    AdcDma &operator=(const AdcDma &);
+};
+
+#endif
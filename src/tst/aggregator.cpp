@@ -0,0 +1,121 @@
+#include "aggregator.hpp"
+#include <math.h>
+
+Aggregator::Aggregator(const AggregateRule rules[], int fields, uint16_t heartbeat)
+    : _rules(rules), _fields(fields), _heartbeat(heartbeat)
+{
+    if (_fields > AGGREGATOR_FIELDS_MAX) {
+        _fields = AGGREGATOR_FIELDS_MAX;
+    }
+    reset();
+}
+
+void Aggregator::reset()
+{
+    for (int i = 0; i < AGGREGATOR_FIELDS_MAX; i++) {
+        _state.sent[i] = NAN;
+    }
+    clearWindow();
+}
+
+void Aggregator::clearWindow()
+{
+    _state.cycles = 0;
+    for (int i = 0; i < AGGREGATOR_FIELDS_MAX; i++) {
+        _state.count[i] = 0;
+        _state.min[i] = NAN;
+        _state.max[i] = NAN;
+        _state.sum[i] = 0;
+        _state.last[i] = NAN;
+    }
+}
+
+void Aggregator::add(const float values[])
+{
+    if (_state.cycles < 0xFFFF) {
+        _state.cycles++;
+    }
+    for (int i = 0; i < _fields; i++) {
+        float v = values[i];
+        _state.last[i] = v;
+        if (isnan(v)) {
+            continue;
+        }
+        if (_state.count[i] == 0 || v < _state.min[i]) {
+            _state.min[i] = v;
+        }
+        if (_state.count[i] == 0 || v > _state.max[i]) {
+            _state.max[i] = v;
+        }
+        _state.sum[i] += v;
+        _state.count[i]++;
+    }
+}
+
+bool Aggregator::pending() const
+{
+    if (_state.cycles == 0) {
+        return false;
+    }
+    if (_state.cycles >= _heartbeat) {
+        return true;
+    }
+    for (int i = 0; i < _fields; i++) {
+        float v = _state.last[i];
+        float ref = _state.sent[i];
+        if (_rules[i].threshold <= 0) {
+            continue;
+        }
+        // Apparition ou disparition d'une mesure, ou écart au seuil
+        if (isnan(v) != isnan(ref)) {
+            return true;
+        }
+        if (!isnan(v) && fabsf(v - ref) >= _rules[i].threshold) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void Aggregator::report(float values[])
+{
+    for (int i = 0; i < _fields; i++) {
+        switch (_rules[i].stat) {
+        case AggregateRule::MEAN:
+            values[i] = mean(i);
+            break;
+        case AggregateRule::MIN:
+            values[i] = min(i);
+            break;
+        case AggregateRule::MAX:
+            values[i] = max(i);
+            break;
+        default:
+            values[i] = last(i);
+            break;
+        }
+        // Référence des seuils : dernière mesure au moment de l'envoi
+        _state.sent[i] = _state.last[i];
+    }
+    clearWindow();
+}
+
+float Aggregator::min(int i) const
+{
+    return _state.min[i];
+}
+
+float Aggregator::max(int i) const
+{
+    return _state.max[i];
+}
+
+float Aggregator::mean(int i) const
+{
+    return (_state.count[i] == 0) ? NAN : _state.sum[i] / _state.count[i];
+}
+
+float Aggregator::last(int i) const
+{
+    return _state.last[i];
+}
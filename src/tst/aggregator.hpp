@@ -0,0 +1,81 @@
+#ifndef __AGGREGATOR_HPP__
+#define __AGGREGATOR_HPP__
+#include <stdint.h>
+
+/* Agrégation des mesures et émission sur événement
+ *
+ * Chaque cycle ajoute une mesure par champ. Sur la fenêtre depuis le
+ * dernier envoi sont tenus, en mémoire constante, le minimum, le
+ * maximum, la moyenne et la dernière valeur de chaque champ.
+ * Un envoi est demandé quand un champ s'écarte de la valeur envoyée de
+ * plus de son seuil, ou quand heartbeat cycles se sont écoulés.
+ *
+ * Chaque champ est envoyé sous la statistique choisie par sa règle :
+ * moyenne pour les grandeurs lentes et bruitées, dernière valeur pour
+ * celles dont un saut doit être vu (poids lors d'un essaimage).
+ *
+ * L'état complet est une structure sans pointeur, sauvegardable telle
+ * quelle si la carte est mise hors tension entre deux cycles.
+ */
+
+// Champs agrégés au plus
+#define AGGREGATOR_FIELDS_MAX 16
+
+struct AggregateRule {
+    enum Stat { LAST, MEAN, MIN, MAX };
+
+    float threshold;        // écart avec la valeur envoyée, 0 : jamais
+    uint8_t stat;           // statistique envoyée
+};
+
+struct AggregatorState {
+    uint16_t cycles;        // cycles depuis le dernier envoi
+    uint16_t count[AGGREGATOR_FIELDS_MAX];
+    float min[AGGREGATOR_FIELDS_MAX];
+    float max[AGGREGATOR_FIELDS_MAX];
+    float sum[AGGREGATOR_FIELDS_MAX];
+    float last[AGGREGATOR_FIELDS_MAX];
+    float sent[AGGREGATOR_FIELDS_MAX];     // NaN avant le premier envoi
+};
+
+class Aggregator
+{
+public:
+    /**
+     * @param rules une règle par champ
+     * @param fields nombre de champs, au plus AGGREGATOR_FIELDS_MAX
+     * @param heartbeat envoi au moins tous les heartbeat cycles
+     */
+    Aggregator(const AggregateRule rules[], int fields, uint16_t heartbeat);
+
+    // Oublie tout, le prochain cycle sera envoyé
+    void reset(void);
+
+    // Ajoute les mesures d'un cycle, NaN pour une mesure absente
+    void add(const float values[]);
+    // Un envoi est nécessaire
+    bool pending(void) const;
+    // Valeurs à envoyer selon les règles, puis nouvelle fenêtre
+    void report(float values[]);
+
+    // Statistiques de la fenêtre en cours, NaN si aucune mesure
+    float min(int i) const;
+    float max(int i) const;
+    float mean(int i) const;
+    float last(int i) const;
+    uint16_t cycles(void) const { return _state.cycles; }
+
+    // Sauvegarde et restauration de l'état
+    const AggregatorState &state(void) const { return _state; }
+    void restore(const AggregatorState &state) { _state = state; }
+
+private:
+    const AggregateRule *_rules;
+    int _fields;
+    uint16_t _heartbeat;
+    AggregatorState _state;
+
+    void clearWindow(void);
+};
+
+#endif
@@ -0,0 +1,97 @@
+#ifndef __AUDIO_DSP_HPP__
+#define __AUDIO_DSP_HPP__
+#include "fftReal.hpp"
+
+/* Noyaux de calcul de la chaîne audio (FFT, fenêtrage, FIR
+ * décimateur), choisis à la compilation par AUDIO_DSP_BACKEND
+ *
+ * AUDIO_DSP_MIKAMI : code C++ portable (Mikami::FftRealN), utilisable
+ *                    sur PC pour les tests
+ * AUDIO_DSP_CMSIS  : noyaux CMSIS-DSP (instructions SIMD/DSP du M4),
+ *                    nécessite la bibliothèque CMSIS-DSP à l'édition
+ *                    de liens (libarm_cortexM4lf_math.a)
+ *
+ * Chaque backend fournit :
+ *   Fft<T, N>             même interface que Mikami::FftRealN
+ *   FftInPlace<T, N>      FFT limitée à Execute(x) en place et
+ *                         MagnitudeSquared(x), sans zone de travail
+ *                         quand le backend le permet
+ *   Multiply(a, b, o, n)  o[k] = a[k]*b[k] (fenêtrage), float, Q15
+ *                         ou Q31 saturé
+ *   FirDecimatorQ15<TAPS, M, BLOCK>
+ *                         FIR Q15 à TAPS coefficients suivi d'une
+ *                         décimation par M, traitement par blocs de
+ *                         BLOCK entrées, accumulation 64 bits.
+ *                         Coefficients dans l'ordre CMSIS (inversés,
+ *                         indifférent pour un filtre à phase linéaire)
+ */
+#define AUDIO_DSP_MIKAMI 0
+#define AUDIO_DSP_CMSIS  1
+
+#ifndef AUDIO_DSP_BACKEND
+#define AUDIO_DSP_BACKEND AUDIO_DSP_MIKAMI
+#endif
+
+// Backend portable
+struct DspMikami
+{
+    template <typename T, int N> using Fft = Mikami::FftRealN<T, N>;
+    template <typename T, int N> using FftInPlace = Mikami::FftRealInPlace<T, N>;
+
+    template <typename T>
+    static void Multiply(const T a[], const T b[], T out[], int n)
+    {
+        for (int k = 0; k < n; k++) {
+            out[k] = Mikami::Windowed(a[k], b[k]);
+        }
+    }
+
+    template <int TAPS, int M, int BLOCK>
+    class FirDecimatorQ15
+    {
+    public:
+        static_assert(BLOCK % M == 0, "BLOCK must be a multiple of M");
+
+        explicit FirDecimatorQ15(const int16_t coefs[TAPS]) : _coefs(coefs)
+        {
+            for (int k = 0; k < TAPS-1; k++) {
+                _state[k] = 0;
+            }
+        }
+
+        // BLOCK entrées x[], BLOCK/M sorties y[]
+        void Process(const int16_t x[], int16_t y[])
+        {
+            // Historique suivi du nouveau bloc
+            int16_t *buf = _state + TAPS-1;
+            for (int n = 0; n < BLOCK; n++) {
+                buf[n] = x[n];
+            }
+            // Seules les sorties conservées sont calculées
+            for (int n = M-1, i = 0; n < BLOCK; n += M, i++) {
+                int64_t acc = 0;
+                const int16_t *px = _state + n;
+                for (int k = 0; k < TAPS; k++) {
+                    acc += (int32_t)_coefs[k]*px[k];
+                }
+                y[i] = Mikami::ComplexQ15::Sat((int32_t)(acc >> 15));
+            }
+            for (int k = 0; k < TAPS-1; k++) {
+                _state[k] = _state[BLOCK + k];
+            }
+        }
+
+    private:
+        const int16_t *_coefs;
+        int16_t _state[TAPS-1 + BLOCK];
+    };
+};
+
+#if AUDIO_DSP_BACKEND == AUDIO_DSP_CMSIS
+#include "audioDspCmsis.hpp"
+typedef DspCmsis AudioDsp;
+#else
+typedef DspMikami AudioDsp;
+#endif
+
+#endif
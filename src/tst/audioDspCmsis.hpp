@@ -0,0 +1,120 @@
+#ifndef __AUDIO_DSP_CMSIS_HPP__
+#define __AUDIO_DSP_CMSIS_HPP__
+
+/* Backend CMSIS-DSP de la chaîne audio, voir audioDsp.hpp
+ * Seule la FFT des échantillons float passe par CMSIS, les FFT en
+ * virgule fixe restent sur Mikami::FftRealN */
+#if defined(TARGET_M4) && !defined(ARM_MATH_CM4)
+#define ARM_MATH_CM4
+#endif
+#include "arm_math.h"
+
+struct DspCmsis
+{
+    // FFT réelle arm_rfft_fast_f32, même interface que Mikami::FftRealN
+    template <int N>
+    class RfftF32
+    {
+    public:
+        typedef Mikami::Complex Cplx;
+
+        RfftF32()
+        {
+            if (arm_rfft_fast_init_f32(&_rfft, N) != ARM_MATH_SUCCESS) {
+                error("Unsupported FFT length\n");
+            }
+        }
+
+        // y[0] ... y[N/2] sont calculés
+        void Execute(const float x[], Cplx y[], const float window[] = NULL)
+        {
+            // arm_rfft_fast_f32 modifie son entrée
+            if (window == NULL) {
+                arm_copy_f32((float32_t *)x, _work, N);
+            } else {
+                arm_mult_f32((float32_t *)x, (float32_t *)window, _work, N);
+            }
+            // Sortie entrelacée : X[0], X[N/2] (réels) puis Re/Im de X[k]
+            float32_t *out = reinterpret_cast<float32_t *>(y);
+            arm_rfft_fast_f32(&_rfft, _work, out, 0);
+            y[N/2] = Cplx(out[1], 0);
+            y[0] = Cplx(out[0], 0);
+        }
+
+        // En place : x[] reçoit la sortie entrelacée de arm_rfft_fast_f32
+        void Execute(float x[])
+        {
+            arm_rfft_fast_f32(&_rfft, x, _work, 0);
+            arm_copy_f32(_work, x, N);
+        }
+
+        // x[0] ... x[N/2] = |X[k]|², en place sur la sortie entrelacée
+        void MagnitudeSquared(float x[]) const
+        {
+            float p0 = x[0]*x[0];
+            float pHalf = x[1]*x[1];
+            // Chaque x[k] est écrit après lecture de x[2k] et x[2k+1]
+            arm_cmplx_mag_squared_f32(x + 2, x + 1, N/2 - 1);
+            x[0] = p0;
+            x[N/2] = pHalf;
+        }
+
+        int Exponent() const { return 0; }
+
+        float Abs(const Cplx &y) const { return std::abs(y); }
+
+    private:
+        arm_rfft_fast_instance_f32 _rfft;
+        float32_t _work[N];
+    };
+
+    template <typename T, int N> struct FftOf { typedef Mikami::FftRealN<T, N> type; };
+    template <int N> struct FftOf<float, N> { typedef RfftF32<N> type; };
+    template <typename T, int N> using Fft = typename FftOf<T, N>::type;
+
+    // RfftF32 garde sa zone de travail : arm_rfft_fast_f32 n'est pas en place
+    template <typename T, int N> struct FftInPlaceOf { typedef Mikami::FftRealInPlace<T, N> type; };
+    template <int N> struct FftInPlaceOf<float, N> { typedef RfftF32<N> type; };
+    template <typename T, int N> using FftInPlace = typename FftInPlaceOf<T, N>::type;
+
+    static void Multiply(const float a[], const float b[], float out[], int n)
+    {
+        arm_mult_f32((float32_t *)a, (float32_t *)b, out, n);
+    }
+
+    // Produits tronqués et non arrondis, contrairement à Mikami::Windowed
+    static void Multiply(const int16_t a[], const int16_t b[], int16_t out[], int n)
+    {
+        arm_mult_q15((q15_t *)a, (q15_t *)b, out, n);
+    }
+
+    static void Multiply(const int32_t a[], const int32_t b[], int32_t out[], int n)
+    {
+        arm_mult_q31((q31_t *)a, (q31_t *)b, (q31_t *)out, n);
+    }
+
+    template <int TAPS, int M, int BLOCK>
+    class FirDecimatorQ15
+    {
+    public:
+        static_assert(BLOCK % M == 0, "BLOCK must be a multiple of M");
+
+        explicit FirDecimatorQ15(const int16_t coefs[TAPS])
+        {
+            arm_fir_decimate_init_q15(&_fir, TAPS, M, (q15_t *)coefs,
+                                      _state, BLOCK);
+        }
+
+        // BLOCK entrées x[], BLOCK/M sorties y[]
+        void Process(const int16_t x[], int16_t y[])
+        {
+            arm_fir_decimate_q15(&_fir, (q15_t *)x, y, BLOCK);
+        }
+
+    private:
+        arm_fir_decimate_instance_q15 _fir;
+        q15_t _state[TAPS-1 + BLOCK];
+    };
+};
+
+#endif
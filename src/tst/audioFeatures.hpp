@@ -0,0 +1,180 @@
+#ifndef __AUDIO_FEATURES_HPP__
+#define __AUDIO_FEATURES_HPP__
+#include "mbed.h"
+
+/* Descripteurs acoustiques de la ruche, calculés en un seul passage
+ * sur la puissance des raies 0 ... N/2 d'une FFT de N points
+ *
+ * - énergie de chaque bande de fréquences
+ * - centroïde spectral
+ * - fréquence du pic, affinée par interpolation parabolique
+ * - valeur efficace (RMS) du signal
+ *
+ * Les raies sont fournies une à une par Push(), dans l'ordre croissant,
+ * aucun tableau n'est conservé. La puissance attendue est celle de
+ * Welch::Power() : |X[k]|² ramené à un signal non fenêtré.
+ * Énergies et RMS sont dans l'unité de l'entrée (au carré pour les
+ * énergies) : la somme des bandes couvrant 0 ... fs/2 vaut Rms()².
+ *
+ * Les raies 0 ... DC_BINS-1, lobe principal de la fenêtre de Hann
+ * autour du continu, sont ignorées : le décalage résiduel de l'entrée
+ * ne compte ni dans le RMS, ni dans le centroïde, ni dans le pic.
+ *
+ * @code
+ * static const AudioFeatures<256, 2>::Band bandes[2] = {
+ *     {100, 300}, {300, 600}
+ * };
+ * AudioFeatures<256, 2> desc(bandes, 4000);
+ *
+ * desc.Execute(spectre);              // Welch<float, 256>
+ * float f = desc.Peak();              // Hz
+ * @endcode
+ */
+template <int N, int BANDS>
+class AudioFeatures
+{
+public:
+    // Raies de la composante continue, ignorées
+    static const int DC_BINS = 2;
+
+    // Bande [low, high[ en Hz
+    struct Band {
+        float low;
+        float high;
+    };
+
+    AudioFeatures(const Band bands[BANDS], float fs) : _df(fs / N)
+    {
+        // Bornes converties une fois pour toutes en indices de raies
+        for (int b = 0; b < BANDS; b++) {
+            _low[b] = (int16_t)ceilf(bands[b].low / _df);
+            _high[b] = (int16_t)ceilf(bands[b].high / _df);
+        }
+        Reset();
+    }
+
+    // Prépare une nouvelle trame
+    void Reset()
+    {
+        for (int b = 0; b < BANDS; b++) {
+            _energy[b] = 0;
+        }
+        _k = 0;
+        _total = 0;
+        _moment = 0;
+        _prev = 0;
+        _peakBin = 0;
+        _peakLeft = _peakCenter = _peakRight = 0;
+        _needRight = false;
+    }
+
+    // Puissance de la raie suivante (0 ... N/2)
+    void Push(float power)
+    {
+        // Spectre unilatéral : les raies 1 ... N/2-1 comptent double
+        float p = (_k < DC_BINS) ? 0 : (_k == N/2) ? power : 2 * power;
+        _total += p;
+        _moment += _k * p;
+        for (int b = 0; b < BANDS; b++) {
+            if (_k >= _low[b] && _k < _high[b]) {
+                _energy[b] += p;
+            }
+        }
+
+        // Pic hors composante continue, voisins gardés pour l'interpolation
+        if (_needRight) {
+            _peakRight = power;
+            _needRight = false;
+        }
+        if (_k >= DC_BINS && power > _peakCenter) {
+            _peakBin = _k;
+            _peakLeft = _prev;
+            _peakCenter = power;
+            _needRight = (_k < N/2);
+        }
+        _prev = power;
+        _k++;
+    }
+
+    // Trame complète depuis une source offrant Power(k), Welch par exemple
+    template <typename S>
+    void Execute(const S &spectrum)
+    {
+        Reset();
+        for (int k = 0; k <= N/2; k++) {
+            Push(spectrum.Power(k));
+        }
+    }
+
+    // Trame complète depuis power[0] ... power[N/2]
+    void Execute(const float power[])
+    {
+        Reset();
+        for (int k = 0; k <= N/2; k++) {
+            Push(power[k]);
+        }
+    }
+
+    // Énergie de la bande b
+    float Energy(int b) const
+    {
+        return _energy[b] / ((float)N * N);
+    }
+
+    // Valeur efficace du signal hors continu (théorème de Parseval)
+    float Rms() const
+    {
+        return sqrtf(_total) / N;
+    }
+
+    // Centroïde spectral en Hz, hors composante continue
+    float Centroid() const
+    {
+        return (_total > 0) ? _df * _moment / _total : 0;
+    }
+
+    // Fréquence du pic en Hz
+    float Peak() const
+    {
+        return _df * (_peakBin + PeakOffset());
+    }
+
+    // Puissance de la raie du pic, même unité que Push()
+    float PeakPower() const
+    {
+        return _peakCenter;
+    }
+
+private:
+    const float _df;            // écart entre raies en Hz
+    int16_t _low[BANDS];
+    int16_t _high[BANDS];
+    float _energy[BANDS];
+    int _k;                     // indice de la prochaine raie
+    float _total;               // somme des puissances
+    float _moment;              // somme des k*puissance
+    float _prev;
+    int _peakBin;
+    float _peakLeft, _peakCenter, _peakRight;
+    bool _needRight;
+
+    /* Décalage du sommet de la parabole passant par les logarithmes
+     * des trois raies autour du pic, dans [-0.5, 0.5] */
+    float PeakOffset() const
+    {
+        if (_peakBin < DC_BINS || _peakBin == N/2 || _peakCenter <= 0) {
+            return 0;
+        }
+        const float tiny = 1e-30f;
+        float a = logf(_peakLeft + tiny);
+        float b = logf(_peakCenter + tiny);
+        float c = logf(_peakRight + tiny);
+        float den = a - 2 * b + c;
+        if (den >= 0) {
+            return 0;
+        }
+        return 0.5f * (a - c) / den;
+    }
+};
+
+#endif
@@ -0,0 +1,39 @@
+#include "battery.hpp"
+
+// Conversions moyennées par mesure
+#define BATTERY_READS 8
+
+Battery::Battery(PinName pin, float ratio)
+    : _pin(pin), _ratio(ratio)
+{
+}
+
+float Battery::vdda()
+{
+    // Reconfigure l'ADC1 en déclenchement logiciel
+    AnalogIn vref(ADC_VREF);
+    uint32_t sum = 0;
+    for (int i = 0; i < BATTERY_READS; i++) {
+        sum += vref.read_u16() >> 4;        // 12 bits
+    }
+    if (sum == 0) {
+        return 0;
+    }
+    // VREFINT_CAL : conversion de VREFINT sous VREFINT_CAL_VREF mV
+    return (float)(*VREFINT_CAL_ADDR) * VREFINT_CAL_VREF * BATTERY_READS / (1000.0f * sum);
+}
+
+float Battery::read()
+{
+    float vdd = vdda();
+    if (_pin == NC) {
+        return vdd;
+    }
+
+    AnalogIn divider(_pin);
+    float sum = 0;
+    for (int i = 0; i < BATTERY_READS; i++) {
+        sum += divider.read();
+    }
+    return sum / BATTERY_READS * vdd * _ratio;
+}
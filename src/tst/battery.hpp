@@ -0,0 +1,37 @@
+#ifndef __BATTERY_HPP__
+#define __BATTERY_HPP__
+#include "mbed.h"
+
+/* Tension de la pile
+ *
+ * VDDA est déduite de la référence interne VREFINT, étalonnée en usine
+ * sous 3,0 V : aucune broche n'est nécessaire quand la pile alimente
+ * directement le 3V3, comme les deux piles AA du montage « Capteur
+ * batterie ». Derrière un régulateur, la pile est lue sur une entrée
+ * analogique à travers un pont diviseur de rapport ratio.
+ *
+ * Utilise l'ADC1 : à lire hors acquisition du micro. AdcDma y laisse
+ * le déclenchement par TIM6, les AnalogIn sont donc construits à
+ * chaque lecture pour que HAL_ADC_Init rétablisse le déclenchement
+ * logiciel.
+ */
+class Battery
+{
+public:
+    /**
+     * @param pin entrée du pont diviseur, NC si la pile alimente VDDA
+     * @param ratio rapport du pont (tension de la pile / tension lue)
+     */
+    Battery(PinName pin = NC, float ratio = 1.0f);
+
+    // Tension en volts, moyenne de quelques conversions
+    float read(void);
+    // Tension d'alimentation de l'ADC en volts
+    float vdda(void);
+
+private:
+    PinName _pin;
+    float _ratio;
+};
+
+#endif
@@ -0,0 +1,134 @@
+#include "dhtReader.hpp"
+
+// Réponse et 40 bits en ~5 ms au plus
+#define DHT_FRAME_US 6000
+// Écart entre fronts descendants : ~78 µs pour un 0, ~120 µs pour un 1
+#define DHT_BIT_US 100
+// Front de réponse, front du premier bit, puis un front par bit
+#define DHT_EDGES (2 + 40)
+
+DhtReader::DhtReader(PinName pin, uint32_t start_us, uint32_t interval_ms, Decoder decode)
+    : _io(pin, PIN_INPUT, OpenDrain, 1), _irq(pin),
+      _start_us(start_us), _interval_ms(interval_ms), _decode(decode),
+      _error(DHT_NOT_PRESENT), _busy(false), _edges(0), _edge_us(0), _bits(0),
+      _access_us(0), _accessed(false), _valid(false), _cached(false),
+      _temperature(0), _humidity(0)
+{
+    // InterruptIn a remis la broche en push-pull sans tirage
+    _io.mode(OpenDrain);
+    _irq.fall(callback(this, &DhtReader::fall));
+    _irq.disable_irq();
+}
+
+void DhtReader::attach(DoneCallback cb)
+{
+    _callback = cb;
+}
+
+bool DhtReader::start()
+{
+    if (_error == DHT_PENDING) {
+        return false;
+    }
+    _error = DHT_PENDING;
+    _cached = false;
+
+    uint64_t since_us = ticker_read_us(get_lp_ticker_data()) - _access_us;
+    if (_accessed && since_us < _interval_ms * 1000ULL) {
+        if (_valid) {
+            // Le capteur n'a pas encore de nouvelle mesure
+            _cached = true;
+            complete(DHT_OK);
+        } else {
+            _wait.attach_us(callback(this, &DhtReader::begin),
+                            _interval_ms * 1000ULL - since_us);
+        }
+        return true;
+    }
+    begin();
+    return true;
+}
+
+// Impulsion de démarrage, dans start() ou à la fin de l'intervalle
+void DhtReader::begin()
+{
+    _accessed = true;
+    _access_us = ticker_read_us(get_lp_ticker_data());
+    _busy = true;
+    sleep_manager_lock_deep_sleep();
+    // Un capteur qui tient la ligne à 0 n'a pas fini sa trame
+    if (_io.read() == 0) {
+        finish(DHT_BUS_BUSY);
+        return;
+    }
+    _io = 0;
+    _io.output();
+    _timeout.attach_us(callback(this, &DhtReader::release), _start_us);
+}
+
+// Fin de l'impulsion de démarrage, contexte d'interruption
+void DhtReader::release()
+{
+    _edges = 0;
+    _bits = 0;
+    _io.input();
+    _irq.enable_irq();
+    _timeout.attach_us(callback(this, &DhtReader::expire), DHT_FRAME_US);
+}
+
+// Front descendant, contexte d'interruption
+void DhtReader::fall()
+{
+    uint32_t now = us_ticker_read();
+    if (_edges >= 2) {
+        _bits = (_bits << 1) | (now - _edge_us > DHT_BIT_US);
+    }
+    _edge_us = now;
+    if (++_edges == DHT_EDGES) {
+        finish(DHT_OK);
+    }
+}
+
+// Trame incomplète, contexte d'interruption
+void DhtReader::expire()
+{
+    finish(_edges == 0 ? DHT_NOT_PRESENT : DHT_TIMEOUT);
+}
+
+// Fin d'un accès au bus
+void DhtReader::finish(int error)
+{
+    {
+        // Le dernier front et l'échéance du Timeout peuvent se croiser
+        CriticalSectionLock lock;
+        if (!_busy) {
+            return;
+        }
+        _irq.disable_irq();
+        _timeout.detach();
+        _busy = false;
+    }
+    sleep_manager_unlock_deep_sleep();
+
+    if (error == DHT_OK) {
+        uint8_t raw[5];
+        for (int i = 0; i < 5; i++) {
+            raw[i] = (uint8_t)(_bits >> (8 * (4 - i)));
+        }
+        if ((uint8_t)(raw[0] + raw[1] + raw[2] + raw[3]) != raw[4]) {
+            error = DHT_CHECKSUM;
+        } else {
+            _decode(raw, _temperature, _humidity);
+        }
+    }
+    _valid = (error == DHT_OK);
+    complete(error);
+}
+
+void DhtReader::complete(int error)
+{
+    _error = error;
+    if (_callback) {
+        _callback(error);
+    }
+}
@@ -0,0 +1,151 @@
+#ifndef __DHT_READER_HPP__
+#define __DHT_READER_HPP__
+#include "mbed.h"
+
+/* Famille DHT : DHT11, DHT22 et AM2302, lecture non bloquante
+ *
+ * Après l'impulsion de démarrage (ligne tenue à 0 par un Timeout, le
+ * coeur dort), le capteur répond 80 µs à 0, 80 µs à 1, puis envoie
+ * 40 bits : 50 µs à 0 suivis de 26-28 µs (bit 0) ou 70 µs (bit 1) à 1.
+ * Seuls les fronts descendants sont suivis par InterruptIn : l'écart
+ * entre deux fronts, ~78 µs ou ~120 µs, donne le bit. Une latence
+ * d'interruption de quelques dizaines de µs est donc tolérée.
+ *
+ * DhtReader porte cette réception, commune à tous les modèles et
+ * présente une seule fois en flash. Dht<Model> fixe à la compilation ce
+ * qui change d'un modèle à l'autre : durée du démarrage, intervalle
+ * minimal entre deux mesures et décodage des 5 octets.
+ *
+ * Le capteur ne doit pas être interrogé plus d'une fois par intervalle.
+ * Dans l'intervalle, start() termine aussitôt avec la dernière mesure
+ * réussie (cached() vrai) ; sans mesure valide, la lecture est
+ * repoussée à la fin de l'intervalle, en deepsleep.
+ *
+ * La trame dure ~5 ms, pendant lesquels le deepsleep est interdit (le
+ * us ticker et les interruptions de front doivent tourner). Le
+ * résultat est disponible quand done() devient vrai ; le callback, s'il
+ * est attaché, est appelé en interruption, ou dans start() pour une
+ * mesure en cache.
+ *
+ * @code
+ * Dht22 dht(D3);
+ *
+ * dht.start();
+ * while (!dht.done()) ThisThread::sleep_for(2);
+ * if (dht.error() == DhtReader::DHT_OK) temp = dht.temperature();
+ * @endcode
+ */
+class DhtReader
+{
+public:
+    enum Error {
+        DHT_OK = 0,
+        DHT_PENDING = 1,        // lecture en cours
+        DHT_BUS_BUSY = 2,       // ligne à 0 avant le démarrage
+        DHT_NOT_PRESENT = 3,    // pas de réponse
+        DHT_TIMEOUT = 4,        // trame incomplète
+        DHT_CHECKSUM = 5,
+    };
+
+    // Fin de lecture, avec le code d'erreur
+    typedef Callback<void(int)> DoneCallback;
+
+    // Appelé à chaque fin de lecture
+    void attach(DoneCallback cb);
+
+    // Lance une lecture, false si une lecture est déjà en cours
+    bool start(void);
+    // La dernière lecture est terminée, réussie ou non
+    bool done(void) const { return _error != DHT_PENDING; }
+    // Résultat de la dernière lecture
+    int error(void) const { return _error; }
+    // La dernière lecture a rendu la mesure précédente, sans accès au bus
+    bool cached(void) const { return _cached; }
+
+    // Dernière mesure réussie, en °C et en %
+    float temperature(void) const { return _temperature; }
+    float humidity(void) const { return _humidity; }
+
+protected:
+    // Décodage des 5 octets reçus, checksum vérifié
+    typedef void (*Decoder)(const uint8_t raw[5], float &temperature, float &humidity);
+
+    DhtReader(PinName pin, uint32_t start_us, uint32_t interval_ms, Decoder decode);
+
+private:
+    DigitalInOut _io;
+    InterruptIn _irq;
+    Timeout _timeout;
+    LowPowerTimeout _wait;
+    const uint32_t _start_us;
+    const uint32_t _interval_ms;
+    const Decoder _decode;
+    DoneCallback _callback;
+    volatile int _error;
+    volatile bool _busy;        // accès au bus en cours
+    volatile uint8_t _edges;
+    volatile uint32_t _edge_us;
+    volatile uint64_t _bits;
+    uint64_t _access_us;        // dernier démarrage, lp ticker
+    bool _accessed;
+    bool _valid;                // la dernière trame reçue était bonne
+    bool _cached;
+    float _temperature;
+    float _humidity;
+
+    void begin(void);
+    void release(void);
+    void fall(void);
+    void expire(void);
+    void finish(int error);
+    void complete(int error);
+
+    // disallow copy constructor and assignment operator
+    DhtReader(const DhtReader &);
+    DhtReader &operator=(const DhtReader &);
+};
+
+// DHT11 : 18 ms de démarrage, une mesure par seconde, entiers et dixièmes
+struct Dht11Model {
+    static const uint32_t START_US = 20000;
+    static const uint32_t INTERVAL_MS = 1000;
+
+    static void decode(const uint8_t raw[5], float &temperature, float &humidity)
+    {
+        humidity = raw[0] + raw[1] * 0.1f;
+        // Signe dans le bit 7 des dixièmes
+        temperature = raw[2] + (raw[3] & 0x7F) * 0.1f;
+        if (raw[3] & 0x80) {
+            temperature = -temperature;
+        }
+    }
+};
+
+// DHT22 et AM2302 : 1 ms de démarrage, une mesure toutes les 2 s, dixièmes sur 16 bits
+struct Dht22Model {
+    static const uint32_t START_US = 1100;
+    static const uint32_t INTERVAL_MS = 2000;
+
+    static void decode(const uint8_t raw[5], float &temperature, float &humidity)
+    {
+        humidity = ((raw[0] << 8) | raw[1]) * 0.1f;
+        // Signe et valeur absolue
+        temperature = (((raw[2] & 0x7F) << 8) | raw[3]) * 0.1f;
+        if (raw[2] & 0x80) {
+            temperature = -temperature;
+        }
+    }
+};
+
+template <class Model>
+class Dht : public DhtReader
+{
+public:
+    Dht(PinName pin) : DhtReader(pin, Model::START_US, Model::INTERVAL_MS, &Model::decode) {}
+};
+
+typedef Dht<Dht11Model> Dht11;
+typedef Dht<Dht22Model> Dht22;
+typedef Dht22 Am2302;
+
+#endif
@@ -0,0 +1,233 @@
+#include "ds1820Bus.hpp"
+
+// Commandes de fonction des DS1820
+#define DS1820_CONVERT 0x44
+#define DS1820_READ_SCRATCHPAD 0xBE
+#define DS1820_WRITE_SCRATCHPAD 0x4E
+
+// Familles
+#define DS18S20_FAMILY 0x10
+#define DS18B20_FAMILY 0x28
+#define DS1822_FAMILY 0x22
+
+// Conversion en 12 bits, divisée par deux à chaque bit en moins
+#define DS1820_CONVERT_12BITS_MS 750
+
+Ds1820Bus::Ds1820Bus(OneWireBus &wire) : _wire(wire), _changed(false), _recheck(false), _bits(12)
+{
+    clear();
+}
+
+bool Ds1820Bus::valid(const uint8_t rom[8])
+{
+    if (OneWireBus::crc8(rom, 7) != rom[7]) {
+        return false;
+    }
+    return rom[0] == DS18S20_FAMILY || rom[0] == DS18B20_FAMILY || rom[0] == DS1822_FAMILY;
+}
+
+void Ds1820Bus::seal()
+{
+    _state.crc = OneWireBus::crc8((const uint8_t *)&_state, offsetof(Ds1820BusState, crc));
+}
+
+void Ds1820Bus::clear()
+{
+    memset(&_state, 0, sizeof(_state));
+    seal();
+    _changed = true;
+}
+
+bool Ds1820Bus::restore(const Ds1820BusState &state)
+{
+    bool ok = state.count <= MAX_PROBES
+              && OneWireBus::crc8((const uint8_t *)&state, offsetof(Ds1820BusState, crc)) == state.crc;
+    for (int i = 0; ok && i < state.count; i++) {
+        ok = valid(state.roms[i]);
+    }
+    if (!ok) {
+        clear();
+        return false;
+    }
+    _state = state;
+    _changed = false;
+    return true;
+}
+
+int Ds1820Bus::enumerate()
+{
+    if (_state.count == 0 || (_recheck && _state.missing) || !verify()) {
+        search();
+    }
+    _recheck = false;
+    return _state.count;
+}
+
+bool Ds1820Bus::verify()
+{
+    uint8_t data[9];
+    for (int i = 0; i < _state.count; i++) {
+        if (!missing(i) && !readScratchpad(_state.roms[i], data)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int Ds1820Bus::search()
+{
+    uint8_t found[MAX_PROBES][8];
+    int n = 0;
+    _wire.reset_search();
+    while (n < MAX_PROBES && _wire.search(found[n])) {
+        // Autres familles ignorées
+        if (valid(found[n])) {
+            n++;
+        }
+    }
+    _wire.reset_search();
+
+    /* Sondes retrouvées à leur indice. Une sonde manquante est
+     * remplacée par une nouvelle, sinon elle garde son indice, notée
+     * absente. Les autres nouvelles à la suite */
+    Ds1820BusState old = _state;
+    bool kept[MAX_PROBES] = { false };
+    bool placed[MAX_PROBES] = { false };
+    for (int i = 0; i < old.count; i++) {
+        for (int k = 0; k < n && !kept[i]; k++) {
+            if (!placed[k] && memcmp(old.roms[i], found[k], 8) == 0) {
+                kept[i] = placed[k] = true;
+            }
+        }
+    }
+    int next = 0;
+    _state.missing = 0;
+    for (int i = 0; i < old.count; i++) {
+        if (kept[i]) {
+            continue;
+        }
+        while (next < n && placed[next]) {
+            next++;
+        }
+        if (next < n) {
+            memcpy(_state.roms[i], found[next], 8);
+            placed[next] = true;
+        } else {
+            _state.missing |= 1 << i;
+        }
+    }
+    for (int k = 0; k < n && _state.count < MAX_PROBES; k++) {
+        if (!placed[k]) {
+            memcpy(_state.roms[_state.count++], found[k], 8);
+        }
+    }
+    seal();
+    _changed |= memcmp(&old, &_state, sizeof(_state)) != 0;
+    return _state.count;
+}
+
+int Ds1820Bus::present() const
+{
+    int n = 0;
+    for (int i = 0; i < _state.count; i++) {
+        n += !missing(i);
+    }
+    return n;
+}
+
+bool Ds1820Bus::add(const uint8_t rom[8])
+{
+    if (_state.count >= MAX_PROBES || !valid(rom)) {
+        return false;
+    }
+    memcpy(_state.roms[_state.count++], rom, 8);
+    seal();
+    _changed = true;
+    return true;
+}
+
+void Ds1820Bus::setResolution(uint8_t bits)
+{
+    if (bits < 9) {
+        bits = 9;
+    }
+    if (bits > 12) {
+        bits = 12;
+    }
+    _bits = bits;
+    // TH, TL puis configuration ; les DS18S20 n'ont pas de configuration
+    if (_wire.reset()) {
+        _wire.skip();
+        _wire.write_byte(DS1820_WRITE_SCRATCHPAD);
+        _wire.write_byte(0);
+        _wire.write_byte(0);
+        _wire.write_byte(((bits - 9) << 5) | 0x1F);
+    }
+}
+
+uint16_t Ds1820Bus::conversion_ms() const
+{
+    // 93,75 ms en 9 bits, arrondi au-dessus
+    return (DS1820_CONVERT_12BITS_MS >> (12 - _bits)) + 1;
+}
+
+bool Ds1820Bus::convert()
+{
+    if (_state.count == 0 || !_wire.reset()) {
+        return false;
+    }
+    _wire.skip();
+    _wire.write_byte(DS1820_CONVERT);
+    return true;
+}
+
+bool Ds1820Bus::done()
+{
+    // Les sondes tiennent le slot de lecture à 0 tant qu'elles convertissent
+    return _wire.read_bit() != 0;
+}
+
+int Ds1820Bus::readAll(float temps[])
+{
+    uint8_t data[9];
+    int n = 0;
+    for (int i = 0; i < _state.count; i++) {
+        if (!missing(i) && readScratchpad(_state.roms[i], data)) {
+            temps[i] = toCelsius(_state.roms[i], data);
+            n++;
+        } else {
+            temps[i] = NAN;
+        }
+    }
+    return n;
+}
+
+bool Ds1820Bus::readScratchpad(const uint8_t rom[8], uint8_t data[9])
+{
+    if (!_wire.reset()) {
+        return false;
+    }
+    _wire.select(rom);
+    _wire.write_byte(DS1820_READ_SCRATCHPAD);
+    _wire.read_bytes(data, 9);
+    // Sonde absente : que des 1, dont le CRC est faux
+    // Ligne tenue à 0 : que des 0, dont le CRC est juste
+    return OneWireBus::crc8(data, 8) == data[8] && data[4] != 0;
+}
+
+float Ds1820Bus::toCelsius(const uint8_t rom[8], const uint8_t data[9])
+{
+    int16_t raw = (int16_t)((data[1] << 8) | data[0]);
+    if (rom[0] == DS18S20_FAMILY) {
+        // Demi-degrés, affinés par COUNT_REMAIN sur 16 pas (COUNT_PER_C)
+        raw = raw << 3;
+        if (data[7] == 0x10) {
+            raw = (raw & 0xFFF0) + 12 - data[6];
+        }
+    } else {
+        // Bits de poids faible indéfinis sous 12 bits
+        uint8_t bits = 9 + ((data[4] >> 5) & 3);
+        raw &= ~((1 << (12 - bits)) - 1);
+    }
+    return raw / 16.0f;
+}
@@ -0,0 +1,126 @@
+#ifndef __DS1820_BUS_HPP__
+#define __DS1820_BUS_HPP__
+#include "mbed.h"
+#include "oneWireUart.hpp"
+
+#define DS1820_PROBES_MAX 8
+static_assert(DS1820_PROBES_MAX <= 8, "Ds1820BusState::missing holds 8 probes");
+
+// Adresses des sondes, sauvegardables telles quelles
+struct Ds1820BusState {
+    uint8_t count;
+    uint8_t missing;            // bit i : sonde i absente à la dernière recherche
+    uint8_t roms[DS1820_PROBES_MAX][8];
+    uint8_t crc;                // CRC 1-Wire des champs précédents
+};
+
+/* Sondes DS1820 d'un bus OneWire, converties toutes à la fois
+ *
+ * Une seule commande Skip ROM + Convert T lance la conversion de toutes
+ * les sondes : le temps d'acquisition est celui d'une sonde, quel que
+ * soit leur nombre. La fin de conversion se lit sur le bus (slot de
+ * lecture à 1 quand toutes ont fini) ou s'attend d'après la résolution.
+ * Les scratchpads sont ensuite lus l'un après l'autre, CRC vérifié.
+ *
+ * Familles reconnues : 0x10 (DS18S20 et DS1820, 9 bits), 0x28
+ * (DS18B20) et 0x22 (DS1822), 9 à 12 bits. Les sondes doivent être
+ * alimentées par VDD : en alimentation parasite, le bus devrait rester
+ * tiré à 1 pendant la conversion.
+ *
+ * Les adresses trouvées sont conservées entre deux mises sous tension
+ * (state() et restore()). Au démarrage, enumerate() vérifie seulement
+ * que chaque sonde connue répond, en lisant son scratchpad (~2 ms par
+ * sonde au lieu de ~15 ms de recherche). La recherche complète n'est
+ * relancée que si une sonde manque : une sonde remplacée reprend
+ * l'indice de l'ancienne ; sans remplaçante, la sonde manquante garde
+ * son indice, se lit NaN et est notée absente dans l'état. Une sonde
+ * notée absente n'est plus vérifiée ni lue : elle ne relance pas la
+ * recherche à chaque démarrage, seulement après recheck(). Elle y
+ * reprend sa place si elle répond de nouveau, ou cède son indice à une
+ * nouvelle sonde. Une sonde ajoutée sans qu'aucune autre ne manque
+ * n'est vue qu'après clear().
+ *
+ * @code
+ * Ds1820Bus sondes(oneWire);
+ * sondes.restore(saved);         // adresses du démarrage précédent
+ * if (boots % 240 == 0) sondes.recheck();
+ * sondes.enumerate();
+ * if (sondes.changed()) saved = sondes.state();
+ * sondes.setResolution(11);
+ *
+ * sondes.convert();
+ * while (!sondes.done()) ThisThread::sleep_for(20);
+ * sondes.readAll(temps);
+ * @endcode
+ */
+class Ds1820Bus
+{
+public:
+    static const int MAX_PROBES = DS1820_PROBES_MAX;
+
+    Ds1820Bus(OneWireBus &wire);
+
+    /* Adresses connues si toutes les sondes répondent, sinon recherche
+     * complète. Retourne le nombre de sondes */
+    int enumerate(void);
+    /* Recherche complète des sondes du bus, retourne leur nombre
+     * Les sondes déjà connues gardent leur indice */
+    int search(void);
+    // La liste a changé depuis restore() : état à sauvegarder
+    bool changed(void) const { return _changed; }
+    // Ajoute une sonde d'adresse connue, false si invalide ou liste pleine
+    bool add(const uint8_t rom[8]);
+    // Oublie les sondes connues : la prochaine énumération cherche
+    void clear(void);
+    // La prochaine énumération cherche si des sondes sont notées absentes
+    void recheck(void) { _recheck = true; }
+
+    int count(void) const { return _state.count; }
+    // Sonde i absente à la dernière recherche
+    bool missing(int i) const { return (_state.missing >> i) & 1; }
+    // Sondes de la liste non notées absentes
+    int present(void) const;
+    const uint8_t *rom(int i) const { return _state.roms[i]; }
+
+    const Ds1820BusState &state(void) const { return _state; }
+    // false si l'état est corrompu : la liste est alors vide
+    bool restore(const Ds1820BusState &state);
+
+    /* Résolution de toutes les sondes, 9 à 12 bits, sans effet sur les
+     * DS18S20. Les seuils d'alarme TH et TL sont remis à zéro */
+    void setResolution(uint8_t bits);
+    uint8_t resolution(void) const { return _bits; }
+    // Durée maximale d'une conversion à la résolution choisie
+    uint16_t conversion_ms(void) const;
+
+    // Lance la conversion de toutes les sondes, false si aucune ne répond
+    bool convert(void);
+    // Toutes les sondes ont fini leur conversion
+    bool done(void);
+    /* Lit le scratchpad de chaque sonde : temps[i] en °C, NaN si la
+     * sonde i est absente, ne répond pas ou si le CRC est faux
+     * Retourne le nombre de sondes lues */
+    int readAll(float temps[]);
+
+    // Sonde de la famille DS1820 et CRC de l'adresse juste
+    static bool valid(const uint8_t rom[8]);
+
+private:
+    OneWireBus &_wire;
+    Ds1820BusState _state;
+    bool _changed;
+    bool _recheck;
+    uint8_t _bits;
+
+    // Toutes les sondes de la liste non notées absentes répondent
+    bool verify(void);
+    void seal(void);
+    bool readScratchpad(const uint8_t rom[8], uint8_t data[9]);
+    static float toCelsius(const uint8_t rom[8], const uint8_t data[9]);
+
+    // disallow copy constructor and assignment operator
+    Ds1820Bus(const Ds1820Bus &);
+    Ds1820Bus &operator=(const Ds1820Bus &);
+};
+
+#endif
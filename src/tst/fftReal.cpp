@@ -1,6 +1,9 @@
 //------------------------------------------------------------------------------
 // FFT class for real data usind decimation-in-frequency algorithm
 //      This class can execute FFT and IFFT 
+//      Real data are packed into an N/2-point complex FFT followed by
+//      a split stage, which halves the arithmetic and the working area
+//      Fixed-point versions use block floating-point scaling per stage
 // Copyright (c) 2015 MIKAMI, Naoki,  2015/10/29
 //------------------------------------------------------------------------------
 
@@ -8,109 +11,271 @@
 
 namespace Mikami
 {
+    // Helpers common to float and fixed-point complex numbers
+
+    static inline Complex Half(const Complex& z) { return 0.5f*z; }
+    template <typename T, typename A>
+    static inline ComplexQ<T, A> Half(const ComplexQ<T, A>& z)
+    { return ComplexQ<T, A>(z.real() >> 1, z.imag() >> 1); }
+
+    // Multiplication by j
+    static inline Complex MulJ(const Complex& z)
+    { return Complex(-z.imag(), z.real()); }
+    template <typename T, typename A>
+    static inline ComplexQ<T, A> MulJ(const ComplexQ<T, A>& z)
+    { return ComplexQ<T, A>(ComplexQ<T, A>::Sat(-(A)z.imag()), z.real()); }
+
+    // Multiplication by -j
+    static inline Complex MulMinusJ(const Complex& z)
+    { return Complex(z.imag(), -z.real()); }
+    template <typename T, typename A>
+    static inline ComplexQ<T, A> MulMinusJ(const ComplexQ<T, A>& z)
+    { return ComplexQ<T, A>(z.imag(), ComplexQ<T, A>::Sat(-(A)z.real())); }
+
+    // a*a + b*b, in Q format for fixed-point
+    static inline float SquareSum(float a, float b) { return a*a + b*b; }
+    static inline int16_t SquareSum(int16_t a, int16_t b)
+    {
+        return ComplexQ15::Sat((((int32_t)a*a) >> 15)
+                             + (((int32_t)b*b) >> 15));
+    }
+    static inline int32_t SquareSum(int32_t a, int32_t b)
+    {
+        return ComplexQ31::Sat((((int64_t)a*a) >> 31)
+                             + (((int64_t)b*b) >> 31));
+    }
+
+    // Block floating-point: scale u[] so that no butterfly can overflow,
+    // if "up" is true small values are also scaled up for precision
+    //      Returns the exponent added by the scaling
+    static inline int Normalize(Complex u[], int n, bool up) { return 0; }
+    template <typename T, typename A>
+    static int Normalize(ComplexQ<T, A> u[], int n, bool up)
+    {
+        const A limit = (A)1 << (ComplexQ<T, A>::FRAC-2);
+        A bits = 0;     // upper bound of magnitude of components
+        for (int k=0; k<n; k++)
+        {
+            A re = u[k].real(), im = u[k].imag();
+            bits |= (re < 0 ? -re : re) | (im < 0 ? -im : im);
+        }
+
+        int shift = 0;
+        while ((bits >> shift) >= limit) shift++;
+        if (up && (bits != 0))
+            while ((bits << -shift) < (limit >> 1)) shift--;
+
+        if (shift > 0)
+            for (int k=0; k<n; k++)
+                u[k] = ComplexQ<T, A>(u[k].real() >> shift,
+                                      u[k].imag() >> shift);
+        else if (shift < 0)
+            for (int k=0; k<n; k++)
+                u[k] = ComplexQ<T, A>((T)(u[k].real() << -shift),
+                                      (T)(u[k].imag() << -shift));
+        return shift;
+    }
+
     // Constructor
-    FftReal::FftReal(int16_t n)
-            : N_FFT_(n), N_INV_(1.0f/n)
+    template <typename T>
+    FftRealT<T>::FftRealT(int16_t n, const Cplx wTable[],
+                          const uint16_t bTable[], Cplx work[])
+            : N_FFT_(n), N_HALF_(n/2), N_INV_(1.0f/n),
+              wTable_(wTable), bTable_(bTable), u_(work), exp_(0)
     {
         // __clz(): Count leading zeros
         uint32_t shifted = n << (__clz(n)+1);
-        if (shifted != 0)
+        if ((shifted != 0) || (n < 4))
         {
             fprintf(stderr, "\r\nNot power of 2, in FftReal class.");
             fprintf(stderr, "\r\nForce to exit the program.");
             exit(EXIT_FAILURE); // Terminate program
         }
-
-        wTable_ = new Complex[n/2];
-        bTable_ = new uint16_t[n];
-        u_ = new Complex[n];
-    
-        // calculation of twiddle factor
-        Complex arg = Complex(0, -6.283185f/N_FFT_);
-        for (int k=0; k<N_FFT_/2; k++)
-            wTable_[k] = exp(arg*(float)k);
-
-        // for bit reversal table
-        uint16_t nShift = __clz(n) + 1;
-        for (int k=0; k<n; k++)
-            // __rbit(k): Reverse the bit order in a 32-bit word
-            bTable_[k] = __rbit(k) >> nShift;        
     }
 
-    // Destructor
-    FftReal::~FftReal()
+    // Execute FFT
+    //      y[0] ... y[N/2] are computed
+    template <typename T>
+    void FftRealT<T>::Execute(const T x[], Cplx y[], const T window[])
     {
-        delete[] wTable_;
-        delete[] bTable_;
-        delete[] u_;    
+        MBED_ASSERT(u_ != NULL);
+
+        // Pack even samples to real part and odd ones to imaginary part
+        if (window == NULL)
+            for (int n=0; n<N_HALF_; n++)
+                u_[n] = Cplx(x[2*n], x[2*n+1]);
+        else
+            for (int n=0; n<N_HALF_; n++)
+                u_[n] = Cplx(Windowed(x[2*n], window[2*n]),
+                             Windowed(x[2*n+1], window[2*n+1]));
+        exp_ = Normalize(u_, N_HALF_, true);
+
+        HalfFft(u_);
+        exp_ += Normalize(u_, N_HALF_, false);
+
+        // Split stage: separate spectra of even and odd samples,
+        // then combine them with the N-point twiddle factors
+        Cplx re0 = Cplx(u_[0].real());
+        Cplx im0 = Cplx(u_[0].imag());
+        y[0] = re0 + im0;
+        y[N_HALF_] = re0 - im0;
+        for (int k=1; k<N_HALF_; k++)
+        {
+            Cplx zk  = u_[bTable_[k]];
+            Cplx zmk = conj(u_[bTable_[N_HALF_-k]]);
+            Cplx fe = Half(zk + zmk);
+            Cplx fo = Half(MulMinusJ(zk - zmk));
+            y[k] = fe + wTable_[k]*fo;
+        }
     }
 
-    // Execute FFT
-    void FftReal::Execute(const float x[], Complex y[])
+    // Execute FFT in place
+    //      Even and odd samples of x[] are already the real and
+    //      imaginary parts of the N/2-point complex input
+    template <typename T>
+    void FftRealT<T>::Execute(T x[])
     {
-        for (int n=0; n<N_FFT_; n++) u_[n] = x[n];
+        Cplx* u = reinterpret_cast<Cplx*>(x);
+        exp_ = Normalize(u, N_HALF_, true);
 
-        // except for last stage
-        ExcludeLastStage();
+        HalfFft(u);
+        exp_ += Normalize(u, N_HALF_, false);
 
-        // Last stage
-        y[0] = u_[0] + u_[1];
-        y[N_FFT_/2] = u_[0] - u_[1];
-        for (int k=2; k<N_FFT_; k+=2)
-            u_[k] = u_[k] + u_[k+1];
-
-        // Reorder to bit reversal
-        for (int k=1; k<N_FFT_/2; k++)
-            y[k] = u_[bTable_[k]];
+        // Bit reversal by swapping
+        for (int k=1; k<N_HALF_; k++)
+        {
+            int r = bTable_[k];
+            if (r > k)
+            {
+                Cplx uTmp = u[k];
+                u[k] = u[r];
+                u[r] = uTmp;
+            }
+        }
+
+        // Split stage, bins k and N/2-k depend on the same two
+        // points so both are computed together
+        Cplx re0 = Cplx(u[0].real());
+        Cplx im0 = Cplx(u[0].imag());
+        u[0] = Cplx((re0 + im0).real(), (re0 - im0).real());
+        for (int k=1; k<=N_HALF_/2; k++)
+        {
+            Cplx zk  = u[k];
+            Cplx zmk = conj(u[N_HALF_-k]);
+            Cplx fe = Half(zk + zmk);
+            Cplx fo = Half(MulMinusJ(zk - zmk));
+            u[k] = fe + wTable_[k]*fo;
+            if (k < N_HALF_-k)
+                u[N_HALF_-k] = conj(fe) + wTable_[N_HALF_-k]*conj(fo);
+        }
+    }
+
+    // Squared magnitude of packed spectrum, in place
+    //      x[k] is written after x[2k] and x[2k+1] have been read
+    template <typename T>
+    void FftRealT<T>::MagnitudeSquared(T x[]) const
+    {
+        T p0 = SquareSum(x[0], (T)0);
+        T pHalf = SquareSum(x[1], (T)0);
+        for (int k=1; k<N_HALF_; k++)
+            x[k] = SquareSum(x[2*k], x[2*k+1]);
+        x[0] = p0;
+        x[N_HALF_] = pHalf;
     }
 
     // Execute IFFT
-    void FftReal::ExecuteIfft(const Complex y[], float x[])
+    //      y[0] ... y[N/2] are used
+    //      For fixed-point, y[] is taken with exponent 0 and
+    //      x[]*2^Exponent() is the result
+    template <typename T>
+    void FftRealT<T>::ExecuteIfft(const Cplx y[], T x[])
     {
-        int half = N_FFT_/2;
+        MBED_ASSERT(u_ != NULL);
 
-        for (int n=0; n<=half; n++) u_[n] = y[n];
-        for (int n=half+1; n<N_FFT_; n++)
-            u_[n] = conj(y[N_FFT_-n]);
+        // Inverse of split stage, conjugated so that the forward
+        // N/2-point FFT computes the inverse transform
+        for (int k=0; k<N_HALF_; k++)
+        {
+            Cplx ymk = conj(y[N_HALF_-k]);
+            Cplx fe = Half(y[k] + ymk);
+            Cplx fo = Half(y[k] - ymk)*conj(wTable_[k]);
+            u_[k] = conj(fe + MulJ(fo));
+        }
+        exp_ = Normalize(u_, N_HALF_, true);
 
-        // except for last stage
-        ExcludeLastStage();
+        HalfFft(u_);
+
+        // Division by N/2: multiplication for float, exponent otherwise
+        float scale = 2.0f*N_INV_;
+        if (numeric_limits<T>::is_integer)
+        {
+            scale = 1.0f;
+            exp_ -= __clz(1) - __clz(N_HALF_);
+        }
+
+        // Unpack including bit reversal
+        for (int n=0; n<N_HALF_; n++)
+        {
+            Cplx un = u_[bTable_[n]];
+            x[2*n]   = (T)(scale*un.real());
+            x[2*n+1] = (T)(scale*conj(un).imag());
+        }
+    }
+
+    // Magnitude of a bin in units of input
+    template <typename T>
+    float FftRealT<T>::Abs(const Cplx& y) const
+    {
+        float re = y.real(), im = y.imag();
+        return ldexpf(sqrtf(re*re + im*im), exp_);
+    }
 
-        // Last stage including bit reversal
-        x[0] = N_INV_*(u_[0].real() + u_[1].real());
-        x[half] = N_INV_*(u_[0].real() - u_[1].real());
+    // N/2-point complex FFT of u[], result in bit reversed order
+    template <typename T>
+    void FftRealT<T>::HalfFft(Cplx u[])
+    {
+        // except for last stage
+        ExcludeLastStage(u);
 
-        for (int n=2; n<N_FFT_; n+=2)
+        // Last stage
+        exp_ += Normalize(u, N_HALF_, false);
+        for (int k=0; k<N_HALF_; k+=2)
         {
-            float un  = u_[n].real();
-            float un1 = u_[n+1].real();
-            x[Index(n)]   = N_INV_*(un + un1);
-            x[Index(n+1)] = N_INV_*(un - un1);
+            Cplx uTmp = u[k+1];
+            u[k+1] = u[k] - uTmp;
+            u[k] = u[k] + uTmp;
         }
     }
 
     // Processing except for last stage
-    void FftReal::ExcludeLastStage()
+    template <typename T>
+    void FftRealT<T>::ExcludeLastStage(Cplx u[])
     {
-        uint16_t nHalf = N_FFT_/2;
-        for (int stg=1; stg<N_FFT_/2; stg*=2)
+        uint16_t nHalf = N_HALF_/2;
+        // twiddle factors of N/2 points are every other entry of wTable_
+        for (int stg=2; stg<N_HALF_; stg*=2)
         {
+            exp_ += Normalize(u, N_HALF_, false);
             uint16_t nHalf2 = nHalf*2;
-            for (int kp=0; kp<N_FFT_; kp+=nHalf2)
+            for (int kp=0; kp<N_HALF_; kp+=nHalf2)
             {
                 uint16_t kx = 0;
                 for (int k=kp; k<kp+nHalf; k++)
                 {
                     // Butterfly operation
-                    Complex uTmp = u_[k+nHalf];
-                    u_[k+nHalf] = (u_[k] - uTmp)*wTable_[kx];
-                    u_[k] = u_[k] + uTmp;
+                    Cplx uTmp = u[k+nHalf];
+                    u[k+nHalf] = (u[k] - uTmp)*wTable_[kx];
+                    u[k] = u[k] + uTmp;
                     kx = kx + stg;
                 }
             }
             nHalf = nHalf/2;
         }        
     }
-}
 
+    // Sample types available
+    template class FftRealT<float>;
+    template class FftRealT<int16_t>;
+    template class FftRealT<int32_t>;
+}
 
@@ -1,6 +1,9 @@
 //-------------------------------------------------------------------
 // FFT class for real data ---- Header
 //      This class can execute FFT and IFFT 
+//      using an N/2-point complex FFT
+//      Sample type: float, int16_t (Q15) or int32_t (Q31)
+//      Tables are computed at compile time by FftRealN
 // Copyright (c) 2015 MIKAMI, Naoki,  2015/12/18
 //-------------------------------------------------------------------
 
@@ -14,35 +17,157 @@ namespace Mikami
 {
     typedef complex<float> Complex; // define "Complex"
 
-    class FftReal
+    // Complex number in fixed-point format
+    //      T: int16_t for Q15 or int32_t for Q31
+    //      A: accumulator type for products
+    //      All operations saturate
+    template <typename T, typename A>
+    class ComplexQ
     {
     public:
+        static const int FRAC = sizeof(T)*8 - 1;    // fractional bits
+
+        constexpr ComplexQ(T re = 0, T im = 0) : re_(re), im_(im) {}
+        constexpr T real() const { return re_; }
+        constexpr T imag() const { return im_; }
+
+        friend ComplexQ operator+(const ComplexQ& a, const ComplexQ& b)
+        { return ComplexQ(Sat((A)a.re_ + b.re_), Sat((A)a.im_ + b.im_)); }
+
+        friend ComplexQ operator-(const ComplexQ& a, const ComplexQ& b)
+        { return ComplexQ(Sat((A)a.re_ - b.re_), Sat((A)a.im_ - b.im_)); }
+
+        // Product with rounding
+        friend ComplexQ operator*(const ComplexQ& a, const ComplexQ& b)
+        {
+            const A round = (A)1 << (FRAC-1);
+            A re = (A)a.re_*b.re_ - (A)a.im_*b.im_;
+            A im = (A)a.re_*b.im_ + (A)a.im_*b.re_;
+            return ComplexQ(Sat((re + round) >> FRAC),
+                            Sat((im + round) >> FRAC));
+        }
+
+        friend ComplexQ conj(const ComplexQ& a)
+        { return ComplexQ(a.re_, Sat(-(A)a.im_)); }
+
+        // Saturation to the range of T
+        static constexpr T Sat(A v)
+        {
+            const A maxV = ((A)1 << FRAC) - 1;
+            if (v > maxV) return (T)maxV;
+            if (v < -maxV-1) return (T)(-maxV-1);
+            return (T)v;
+        }
+
+    private:
+        T re_, im_;
+    };
+
+    typedef ComplexQ<int16_t, int32_t> ComplexQ15;
+    typedef ComplexQ<int32_t, int64_t> ComplexQ31;
+
+    // Complex type associated with each sample type
+    template <typename T> struct FftSample;
+    template <> struct FftSample<float>   { typedef Complex    Cplx; };
+    template <> struct FftSample<int16_t> { typedef ComplexQ15 Cplx; };
+    template <> struct FftSample<int32_t> { typedef ComplexQ31 Cplx; };
+
+    // Sample multiplied by window
+    inline float Windowed(float x, float w) { return x*w; }
+    inline int16_t Windowed(int16_t x, int16_t w)
+    { return ComplexQ15::Sat(((int32_t)x*w + (1 << 14)) >> 15); }
+    inline int32_t Windowed(int32_t x, int32_t w)
+    { return ComplexQ31::Sat(((int64_t)x*w + (1 << 30)) >> 31); }
+
+    template <typename T>
+    class FftRealT
+    {
+    public:
+        typedef typename FftSample<T>::Cplx Cplx;
+
         // Constructor
-        explicit FftReal(int16_t n);
-        // Destructor
-        ~FftReal();
+        //      wTable: N/2 twiddle factors of N points
+        //      bTable: bit reversal of N/2 points
+        //      work:   working area of N/2 points, may be NULL if
+        //              only the in-place Execute(x) is used
+        FftRealT(int16_t n, const Cplx wTable[], const uint16_t bTable[],
+                 Cplx work[]);
         // Execute FFT
-        void Execute(const float x[], Complex y[]);
+        //      If window is given, x[] is multiplied by it on the fly
+        void Execute(const T x[], Cplx y[], const T window[] = NULL);
+        // Execute FFT in place, no working area is used
+        //      x[] of N samples is replaced by the packed spectrum:
+        //      x[0] = Re X[0], x[1] = Re X[N/2],
+        //      x[2k] = Re X[k], x[2k+1] = Im X[k] for k = 1 ... N/2-1
+        //      (same layout as arm_rfft_fast_f32)
+        void Execute(T x[]);
+        // Squared magnitude of packed spectrum of Execute(x), in place
+        //      x[0] ... x[N/2] are computed
+        //      For fixed-point, value = x[k]*2^(2*Exponent()+FRAC)
+        void MagnitudeSquared(T x[]) const;
         // Execute IFFT
-        void ExecuteIfft(const Complex y[], float x[]);
+        void ExecuteIfft(const Cplx y[], T x[]);
+        // Block exponent of last result: value = result*2^Exponent()
+        //      Always 0 for float
+        int Exponent() const { return exp_; }
+        // Magnitude of a bin of last Execute() in units of input
+        float Abs(const Cplx& y) const;
 
     private:
         const int   N_FFT_;
+        const int   N_HALF_;
         const float N_INV_;
         
-        Complex*    wTable_;    // twiddle factor
-        uint16_t*   bTable_;    // for bit reversal
-        Complex*    u_;         // working area
+        const Cplx*     wTable_;    // twiddle factor
+        const uint16_t* bTable_;    // for bit reversal of N/2 points
+        Cplx*           u_;         // working area of N/2 points or NULL
+        int         exp_;       // block exponent for fixed-point
 
+        // N/2-point complex FFT of u[]
+        void HalfFft(Cplx u[]);
         // Processing except for last stage
-        void ExcludeLastStage();
-        // Use for reordering of rit reversal in IFFT
-        int Index(int n) { return (N_FFT_-bTable_[n]); }
+        void ExcludeLastStage(Cplx u[]);
 
         // disallow copy constructor and assignment operator
-        FftReal(const FftReal& );
-        FftReal& operator=(const FftReal& );
+        FftRealT(const FftRealT& );
+        FftRealT& operator=(const FftRealT& );
     };
+
 }
-#endif  // FFT_REAL_HPP
 
+#include "fftTables.hpp"
+
+namespace Mikami
+{
+    // N-point FFT with tables in flash and working area inside the
+    // object: no heap allocation nor math at construction
+    //      WORK = false: no working area, only Execute(x) in place
+    template <typename T, int N, bool WORK = true>
+    class FftRealN : public FftRealT<T>
+    {
+    public:
+        typedef typename FftRealT<T>::Cplx Cplx;
+        typedef FftTables<Cplx, N> Tables;
+
+        FftRealN() : FftRealT<T>(N, Tables::W.data(), Tables::B.data(), work_) {}
+
+    private:
+        Cplx work_[N/2];
+    };
+
+    template <typename T, int N>
+    class FftRealN<T, N, false> : public FftRealT<T>
+    {
+    public:
+        typedef typename FftRealT<T>::Cplx Cplx;
+        typedef FftTables<Cplx, N> Tables;
+
+        FftRealN() : FftRealT<T>(N, Tables::W.data(), Tables::B.data(), NULL) {}
+    };
+
+    template <int N> using FftReal    = FftRealN<float, N>;
+    template <int N> using FftRealQ15 = FftRealN<int16_t, N>;
+    template <int N> using FftRealQ31 = FftRealN<int32_t, N>;
+    template <typename T, int N> using FftRealInPlace = FftRealN<T, N, false>;
+}
+#endif  // FFT_REAL_HPP
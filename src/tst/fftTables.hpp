@@ -0,0 +1,219 @@
+//-------------------------------------------------------------------
+// Tables for FftReal computed at compile time
+//      Twiddle factors and bit reversal indices for an N-point
+//      real FFT, analysis windows and decimation filters are
+//      constexpr, hence placed in flash
+//-------------------------------------------------------------------
+
+#ifndef FFT_TABLES_HPP
+#define FFT_TABLES_HPP
+
+#include <array>
+#include <utility>  // requisite for index_sequence
+
+namespace Mikami
+{
+    namespace ConstMath
+    {
+        constexpr double PI = 3.14159265358979323846;
+
+        // Reduction of x within [-pi, pi]
+        constexpr double Reduce(double x)
+        {
+            while (x > PI) x -= 2*PI;
+            while (x < -PI) x += 2*PI;
+            return x;
+        }
+
+        // Taylor series after reduction
+        constexpr double Sin(double x)
+        {
+            x = Reduce(x);
+            double term = x, sum = x;
+            for (int k=1; k<15; k++)
+            {
+                term *= -x*x/((2*k)*(2*k+1));
+                sum += term;
+            }
+            return sum;
+        }
+
+        constexpr double Cos(double x)
+        {
+            x = Reduce(x);
+            double term = 1, sum = 1;
+            for (int k=1; k<15; k++)
+            {
+                term *= -x*x/((2*k-1)*(2*k));
+                sum += term;
+            }
+            return sum;
+        }
+
+        // Reverse the order of the "bits" lower bits of k
+        constexpr uint16_t BitReverse(uint32_t k, int bits)
+        {
+            uint16_t r = 0;
+            for (int b=0; b<bits; b++)
+            {
+                r = (r << 1) | (k & 1);
+                k >>= 1;
+            }
+            return r;
+        }
+
+        constexpr int Log2(uint32_t n)
+        {
+            int b = 0;
+            while (n > 1) { n >>= 1; b++; }
+            return b;
+        }
+    }
+
+    // Conversion of a twiddle factor to the complex type of the FFT
+    template <typename C> struct ConstCplx
+    {
+        static constexpr C Make(double re, double im)
+        { return C((float)re, (float)im); }
+    };
+
+    template <typename T, typename A> struct ConstCplx<ComplexQ<T, A> >
+    {
+        static constexpr T Round(double v)
+        {
+            double s = v*(double)((A)1 << ComplexQ<T, A>::FRAC);
+            return ComplexQ<T, A>::Sat((A)(s < 0 ? s - 0.5 : s + 0.5));
+        }
+        static constexpr ComplexQ<T, A> Make(double re, double im)
+        { return ComplexQ<T, A>(Round(re), Round(im)); }
+    };
+
+    // Conversion of a real value within [-1, 1] to a sample type
+    template <typename T> struct ConstSample
+    {
+        static constexpr T Make(double v) { return (T)v; }
+    };
+
+    template <> struct ConstSample<int16_t>
+    {
+        static constexpr int16_t Make(double v)
+        { return ConstCplx<ComplexQ15>::Round(v); }
+    };
+
+    template <> struct ConstSample<int32_t>
+    {
+        static constexpr int32_t Make(double v)
+        { return ConstCplx<ComplexQ31>::Round(v); }
+    };
+
+    template <typename C, int N, size_t... K>
+    constexpr std::array<C, N/2> MakeTwiddles(std::index_sequence<K...>)
+    {
+        // W_N^k = exp(-j*2*pi*k/N), k < N/2 so that the angle is within [0, pi)
+        return {{ ConstCplx<C>::Make(ConstMath::Cos(2*ConstMath::PI*K/N),
+                                     -ConstMath::Sin(2*ConstMath::PI*K/N))... }};
+    }
+
+    template <int N, size_t... K>
+    constexpr std::array<uint16_t, N/2> MakeBitReversal(std::index_sequence<K...>)
+    {
+        return {{ ConstMath::BitReverse(K, ConstMath::Log2(N/2))... }};
+    }
+
+    // Tables for an N-point real FFT with complex type C
+    template <typename C, int N>
+    struct FftTables
+    {
+        static_assert((N >= 4) && ((N & (N-1)) == 0), "N must be a power of 2");
+
+        // Twiddle factors of N points
+        static constexpr std::array<C, N/2> W
+            = MakeTwiddles<C, N>(std::make_index_sequence<N/2>());
+        // Bit reversal of N/2 points
+        static constexpr std::array<uint16_t, N/2> B
+            = MakeBitReversal<N>(std::make_index_sequence<N/2>());
+    };
+
+    // Windows for spectral estimation (periodic form)
+    enum WindowType { WINDOW_RECT, WINDOW_HANN, WINDOW_HAMMING };
+
+    constexpr double WindowValue(WindowType type, int n, int N)
+    {
+        return (type == WINDOW_HANN)
+                    ? 0.5 - 0.5*ConstMath::Cos(2*ConstMath::PI*n/N)
+             : (type == WINDOW_HAMMING)
+                    ? 0.54 - 0.46*ConstMath::Cos(2*ConstMath::PI*n/N)
+             : 1.0;
+    }
+
+    template <typename T, int N, WindowType TYPE, size_t... K>
+    constexpr std::array<T, N> MakeWindow(std::index_sequence<K...>)
+    {
+        return {{ ConstSample<T>::Make(WindowValue(TYPE, K, N))... }};
+    }
+
+    constexpr double WindowPower(WindowType type, int N)
+    {
+        double sum = 0;
+        for (int n=0; n<N; n++)
+            sum += WindowValue(type, n, N)*WindowValue(type, n, N);
+        return sum/N;
+    }
+
+    // Window of N samples of type T
+    template <typename T, int N, WindowType TYPE>
+    struct WindowTable
+    {
+        static constexpr std::array<T, N> W
+            = MakeWindow<T, N, TYPE>(std::make_index_sequence<N>());
+        // Mean of squared window, for normalization of power
+        static constexpr float POWER = (float)WindowPower(TYPE, N);
+    };
+
+    // Low-pass FIR for decimation by M: Hamming windowed sinc,
+    // cut-off at 90 % of output Nyquist frequency, unity gain at DC
+    constexpr double LowPassRaw(int n, int taps, int m)
+    {
+        const double fc = 0.45/m;   // relative to input sampling frequency
+        const double t = n - 0.5*(taps-1);
+        return ((t == 0) ? 2*fc : ConstMath::Sin(2*ConstMath::PI*fc*t)/(ConstMath::PI*t))
+               *WindowValue(WINDOW_HAMMING, n, taps-1);
+    }
+
+    constexpr double LowPassGain(int taps, int m)
+    {
+        double sum = 0;
+        for (int n=0; n<taps; n++)
+            sum += LowPassRaw(n, taps, m);
+        return sum;
+    }
+
+    template <typename T, int TAPS, int M, size_t... K>
+    constexpr std::array<T, TAPS> MakeLowPass(std::index_sequence<K...>)
+    {
+        return {{ ConstSample<T>::Make(LowPassRaw(K, TAPS, M)
+                                       /LowPassGain(TAPS, M))... }};
+    }
+
+    // Coefficients of TAPS-tap anti-aliasing filter for decimation by M
+    //      Symmetric, so the reversed order of CMSIS is the same
+    template <typename T, int TAPS, int M>
+    struct LowPassTable
+    {
+        static_assert((TAPS & 1) == 1, "TAPS must be odd");
+        static constexpr std::array<T, TAPS> H
+            = MakeLowPass<T, TAPS, M>(std::make_index_sequence<TAPS>());
+    };
+
+    template <typename C, int N>
+    constexpr std::array<C, N/2> FftTables<C, N>::W;
+    template <typename C, int N>
+    constexpr std::array<uint16_t, N/2> FftTables<C, N>::B;
+    template <typename T, int N, WindowType TYPE>
+    constexpr std::array<T, N> WindowTable<T, N, TYPE>::W;
+    template <typename T, int N, WindowType TYPE>
+    constexpr float WindowTable<T, N, TYPE>::POWER;
+    template <typename T, int TAPS, int M>
+    constexpr std::array<T, TAPS> LowPassTable<T, TAPS, M>::H;
+}
+#endif  // FFT_TABLES_HPP
@@ -0,0 +1,185 @@
+#include "flashLog.hpp"
+#include <stddef.h>
+#include <string.h>
+
+FlashLog::FlashLog(uint32_t address, uint32_t size)
+    : _address(address), _size(size), _sectorSize(0), _perSector(0), _capacity(0),
+      _head(0), _first(0), _next(0), _stagedNr(0)
+{
+}
+
+int FlashLog::init()
+{
+    int err = _flash.init();
+    if (err != 0) {
+        return err;
+    }
+
+    if (_address == 0) {
+#if MBED_CONF_STORAGE_TDB_INTERNAL_INTERNAL_BASE_ADDRESS
+        uint32_t end = MBED_CONF_STORAGE_TDB_INTERNAL_INTERNAL_BASE_ADDRESS;
+#else
+        uint32_t end = _flash.get_flash_start() + _flash.get_flash_size();
+        for (int i = 0; i < FLASH_LOG_KV_SECTORS; i++) {
+            end -= _flash.get_sector_size(end - 1);
+        }
+#endif
+        _address = end - _size;
+    }
+    // La zone ne doit pas recouvrir le programme
+    MBED_ASSERT(_address >= FLASHIAP_APP_ROM_END_ADDR);
+    MBED_ASSERT(sizeof(LogRecord) % _flash.get_page_size() == 0);
+
+    _sectorSize = _flash.get_sector_size(_address);
+    _perSector = _sectorSize / sizeof(LogRecord);
+    _capacity = (_size / _sectorSize) * _perSector;
+    MBED_ASSERT(_size / _sectorSize >= 2);
+
+    // Secteur le plus récent et plus ancienne mesure
+    LogRecord record;
+    uint32_t sectors = _size / _sectorSize;
+    uint32_t newest = sectors;
+    bool found = false;
+    for (uint32_t s = 0; s < sectors; s++) {
+        if (!readSlot(s * _perSector, record)) {
+            continue;
+        }
+        if (!found || record.seq < _first) {
+            _first = record.seq;
+        }
+        if (!found || record.seq > _next) {
+            _next = record.seq;
+            newest = s;
+        }
+        found = true;
+    }
+    _stagedNr = 0;
+    if (!found) {
+        _head = 0;
+        _first = 0;
+        _next = 0;
+        return 0;
+    }
+
+    // Premier emplacement vierge du secteur le plus récent
+    _head = newest * _perSector;
+    uint32_t end = _head + _perSector;
+    while (_head < end) {
+        if (!readSlot(_head, record) || record.seq != _next) {
+            if (blank(_head)) {
+                break;
+            }
+            // Enregistrement interrompu par une coupure : sauté avec son numéro
+        }
+        _head++;
+        _next++;
+    }
+    _head %= _capacity;
+    return 0;
+}
+
+uint32_t FlashLog::append(const uint8_t frame[], uint32_t time)
+{
+    if (_stagedNr == FLASH_LOG_STAGED) {
+        flush();
+    }
+    LogRecord &record = _staged[_stagedNr++];
+    record.seq = _next++;
+    record.time = time;
+    memcpy(record.frame, frame, sizeof(record.frame));
+    record.check = checksum(record);
+    return record.seq;
+}
+
+int FlashLog::flush()
+{
+    int done = 0;
+    int err = 0;
+    while (done < _stagedNr && err == 0) {
+        uint32_t offset = _head % _perSector;
+        if (offset == 0) {
+            // La tête entre dans le secteur : il perd les plus anciennes mesures
+            uint32_t sector = _head / _perSector;
+            uint32_t stored = _next - _stagedNr + done;     // numéro en tête
+            uint32_t oldest = (_head + _capacity - (stored - _first) % _capacity) % _capacity;
+            if (stored != _first && oldest / _perSector == sector) {
+                _first += _perSector - oldest % _perSector;
+            }
+            err = _flash.erase(_address + sector * _sectorSize, _sectorSize);
+            if (err != 0) {
+                break;
+            }
+        }
+        int run = _perSector - offset;
+        if (run > _stagedNr - done) {
+            run = _stagedNr - done;
+        }
+        err = _flash.program(&_staged[done], slotAddress(_head), run * sizeof(LogRecord));
+        _head = (_head + run) % _capacity;
+        done += run;
+    }
+    // En cas d'erreur les mesures en attente sont perdues, pas la zone
+    _stagedNr = 0;
+    return err;
+}
+
+int FlashLog::read(uint32_t seq, LogRecord records[], int max)
+{
+    flush();
+    if (seq < _first) {
+        seq = _first;
+    }
+    if (seq > _next) {
+        return 0;
+    }
+    // Le numéro n occupe l'emplacement n + (_head - _next) modulo la capacité
+    uint32_t slot = (seq + _capacity - (_next - _head) % _capacity) % _capacity;
+    int n = 0;
+    for (; seq != _next && n < max; seq++, slot = (slot + 1) % _capacity) {
+        if (readSlot(slot, records[n]) && records[n].seq == seq) {
+            n++;
+        }
+    }
+    return n;
+}
+
+uint32_t FlashLog::slotAddress(uint32_t slot) const
+{
+    return _address + (slot / _perSector) * _sectorSize
+           + (slot % _perSector) * sizeof(LogRecord);
+}
+
+bool FlashLog::readSlot(uint32_t slot, LogRecord &record)
+{
+    if (_flash.read(&record, slotAddress(slot), sizeof(record)) != 0) {
+        return false;
+    }
+    return record.check == checksum(record);
+}
+
+bool FlashLog::blank(uint32_t slot)
+{
+    uint8_t raw[sizeof(LogRecord)];
+    if (_flash.read(raw, slotAddress(slot), sizeof(raw)) != 0) {
+        return false;
+    }
+    uint8_t erased = _flash.get_erase_value();
+    for (size_t i = 0; i < sizeof(raw); i++) {
+        if (raw[i] != erased) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// FNV-1a sur tout l'enregistrement sauf la somme elle-même
+uint32_t FlashLog::checksum(const LogRecord &record)
+{
+    const uint8_t *p = (const uint8_t *)&record;
+    uint32_t h = 2166136261UL;
+    for (size_t i = 0; i < offsetof(LogRecord, check); i++) {
+        h = (h ^ p[i]) * 16777619UL;
+    }
+    // Un secteur effacé ne doit jamais paraître valide
+    return (h == 0xFFFFFFFF) ? 0 : h;
+}
@@ -0,0 +1,101 @@
+#ifndef __FLASH_LOG_HPP__
+#define __FLASH_LOG_HPP__
+#include "mbed.h"
+#include "telemetry.hpp"
+
+/* Journal des mesures en flash interne, en anneau
+ *
+ * Chaque enregistrement (24 octets, multiple de la double mot
+ * programmable du STM32L4) contient un numéro croissant, l'heure et la
+ * trame absolue des mesures du cycle. Les enregistrements sont écrits
+ * à la suite, secteur après secteur : un secteur n'est effacé qu'au
+ * moment où la tête y entre, il perd alors les mesures les plus
+ * anciennes. Toute la zone s'use donc au même rythme : à un
+ * enregistrement par cycle de 6 min, chaque secteur est effacé tous les
+ * 5,7 jours, loin des 10 000 effacements garantis.
+ *
+ * append() ne fait que copier en RAM, flush() programme les
+ * enregistrements en attente en un seul appel par secteur : quelques
+ * centaines de µs par cycle, plus l'effacement d'une page (~22 ms) tous
+ * les 85 enregistrements.
+ *
+ * Au démarrage, init() retrouve la tête en lisant le premier
+ * enregistrement de chaque secteur puis le secteur le plus récent. Un
+ * enregistrement interrompu par une coupure est sauté avec son numéro,
+ * le numéro n donne toujours l'emplacement n modulo la capacité.
+ *
+ * Par défaut la zone est placée juste sous le KVStore interne
+ * (TDBStore) : sous storage_tdb_internal.internal_base_address si
+ * mbed_app.json le fixe, sinon sous les deux derniers secteurs de la
+ * flash que le TDBStore prend par défaut. Le TDBStore est lui aussi
+ * écrit à la suite, mais il réécrit à chaque cycle les états complets
+ * (~0,8 ko) : sur deux secteurs, chacun serait effacé tous les deux ou
+ * trois cycles, usé en trois mois. mbed_app.json lui donne 64 ko, soit
+ * un effacement par secteur tous les ~80 cycles, une dizaine d'années.
+ */
+
+// Taille par défaut de la zone (16 secteurs, 1360 enregistrements)
+#define FLASH_LOG_SIZE (32 * 1024)
+// Secteurs de fin de flash pris par le TDBStore interne sans configuration
+#define FLASH_LOG_KV_SECTORS 2
+// Enregistrements en attente avant programmation forcée
+#define FLASH_LOG_STAGED 8
+
+struct LogRecord {
+    uint32_t seq;                           // numéro de la mesure
+    uint32_t time;                          // heure RTC, secondes
+    uint8_t frame[TELEMETRY_FRAME_MAX];     // trame absolue
+    uint32_t check;                         // somme de contrôle
+};
+
+class FlashLog
+{
+public:
+    /**
+     * @param address début de la zone, 0 : sous le KVStore interne
+     * @param size taille de la zone, au moins deux secteurs
+     */
+    FlashLog(uint32_t address = 0, uint32_t size = FLASH_LOG_SIZE);
+
+    // Ouvre la flash et retrouve la tête, 0 ou code d'erreur FlashIAP
+    int init(void);
+
+    /** Ajoute une mesure, programmée au prochain flush()
+     * @return numéro de l'enregistrement
+     */
+    uint32_t append(const uint8_t frame[], uint32_t time);
+    // Programme les enregistrements en attente, 0 ou code d'erreur
+    int flush(void);
+
+    // Numéros de la plus ancienne mesure conservée et de la prochaine
+    uint32_t first(void) const { return _first; }
+    uint32_t next(void) const { return _next; }
+    uint32_t count(void) const { return _next - _first; }
+
+    /** Relit les mesures à partir du numéro seq
+     * Les enregistrements illisibles sont sautés : records[i].seq
+     * indique le numéro de chaque mesure lue.
+     * @return nombre d'enregistrements lus
+     */
+    int read(uint32_t seq, LogRecord records[], int max);
+
+private:
+    FlashIAP _flash;
+    uint32_t _address;
+    uint32_t _size;
+    uint32_t _sectorSize;
+    uint32_t _perSector;    // enregistrements par secteur
+    uint32_t _capacity;     // enregistrements de la zone
+    uint32_t _head;         // emplacement du prochain enregistrement programmé
+    uint32_t _first;
+    uint32_t _next;
+    LogRecord _staged[FLASH_LOG_STAGED];
+    int _stagedNr;
+
+    uint32_t slotAddress(uint32_t slot) const;
+    bool readSlot(uint32_t slot, LogRecord &record);
+    bool blank(uint32_t slot);
+    static uint32_t checksum(const LogRecord &record);
+};
+
+#endif
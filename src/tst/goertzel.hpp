@@ -0,0 +1,133 @@
+//-------------------------------------------------------------------
+// Goertzel filters computing a few bins of an N-point DFT
+//      Same interface and output type as Mikami::FftRealN, so one
+//      can replace the other when only some bins are needed
+//      Bins are template parameters: coefficients are in flash
+//-------------------------------------------------------------------
+
+#ifndef GOERTZEL_HPP
+#define GOERTZEL_HPP
+
+#include "fftReal.hpp"
+
+/* Exemple :
+ * @code
+ * Goertzel<float, 256, 22, 29, 33, 64> g;   // 344, 453, 515, 1000 Hz à 4 kHz
+ * Mikami::Complex y[256];
+ *
+ * g.Execute(x, y);            // y[22], y[29], y[33], y[64] sont calculés
+ *
+ * // ou au fil de l'acquisition
+ * g.Reset();
+ * g.Push(trame0, 128);
+ * g.Push(trame1, 128);
+ * g.Result(y);
+ * @endcode
+ */
+template <typename T, int N, int... K>
+class Goertzel
+{
+public:
+    typedef typename Mikami::FftSample<T>::Cplx Cplx;
+    static const int BINS = sizeof...(K);
+
+    Goertzel() : count_(0), exp_(0) { Reset(); }
+
+    // Restart a new block of N samples
+    void Reset()
+    {
+        for (int b=0; b<BINS; b++) s1_[b] = s2_[b] = 0;
+        count_ = 0;
+    }
+
+    // Process samples as they arrive, samples beyond N are ignored
+    void Push(const T x[], int n)
+    {
+        if (n > N - count_) n = N - count_;
+        for (int i=0; i<n; i++)
+        {
+            float xi = x[i];
+            for (int b=0; b<BINS; b++)
+            {
+                float s0 = xi + COEF[b]*s1_[b] - s2_[b];
+                s2_[b] = s1_[b];
+                s1_[b] = s0;
+            }
+        }
+        count_ += n;
+    }
+
+    // Samples processed since Reset(), N when the block is complete
+    int Count() const { return count_; }
+
+    // Write bins K... of y[], other bins are not modified
+    void Result(Cplx y[])
+    {
+        float re[BINS], im[BINS];
+        float maxV = 0;
+        for (int b=0; b<BINS; b++)
+        {
+            // X[k] = exp(j*w)*s[N-1] - s[N-2]
+            re[b] = 0.5f*COEF[b]*s1_[b] - s2_[b];
+            im[b] = SIN[b]*s1_[b];
+            maxV = fmaxf(maxV, fmaxf(fabsf(re[b]), fabsf(im[b])));
+        }
+        exp_ = BlockExponent(maxV, (Cplx*)0);
+        for (int b=0; b<BINS; b++)
+            y[BIN[b]] = MakeBin(ldexpf(re[b], -exp_), ldexpf(im[b], -exp_), (Cplx*)0);
+    }
+
+    // Same as FftRealN::Execute() for bins K...
+    void Execute(const T x[], Cplx y[])
+    {
+        Reset();
+        Push(x, N);
+        Result(y);
+    }
+
+    // Block exponent of last result: value = result*2^Exponent()
+    int Exponent() const { return exp_; }
+
+    // Magnitude of a bin of last Result() in units of input
+    float Abs(const Cplx& y) const
+    {
+        float re = y.real(), im = y.imag();
+        return ldexpf(sqrtf(re*re + im*im), exp_);
+    }
+
+private:
+    static constexpr int   BIN[]  = { K... };
+    static constexpr float COEF[] = { (float)(2*Mikami::ConstMath::Cos(2*Mikami::ConstMath::PI*K/N))... };
+    static constexpr float SIN[]  = { (float)Mikami::ConstMath::Sin(2*Mikami::ConstMath::PI*K/N)... };
+
+    float s1_[BINS], s2_[BINS];     // filter states
+    int   count_;                   // samples processed
+    int   exp_;
+
+    // Float result: no scaling
+    static int BlockExponent(float, Mikami::Complex*) { return 0; }
+    static Cplx MakeBin(float re, float im, Mikami::Complex*) { return Cplx(re, im); }
+
+    // Fixed-point result: largest component fits in T
+    template <typename Q, typename A>
+    static int BlockExponent(float maxV, Mikami::ComplexQ<Q, A>*)
+    {
+        int e = 0;
+        if (maxV > 0) frexpf(maxV, &e);
+        return e - Mikami::ComplexQ<Q, A>::FRAC;
+    }
+    template <typename Q, typename A>
+    static Cplx MakeBin(float re, float im, Mikami::ComplexQ<Q, A>*)
+    {
+        return Cplx(Cplx::Sat((A)lrintf(re)), Cplx::Sat((A)lrintf(im)));
+    }
+};
+
+template <typename T, int N, int... K>
+constexpr int Goertzel<T, N, K...>::BIN[];
+template <typename T, int N, int... K>
+constexpr float Goertzel<T, N, K...>::COEF[];
+template <typename T, int N, int... K>
+constexpr float Goertzel<T, N, K...>::SIN[];
+
+#endif  // GOERTZEL_HPP
@@ -0,0 +1,122 @@
+#include "interval.hpp"
+#include <math.h>
+
+// Heure RTC considérée comme réglée au-delà du 1er janvier 2020
+#define RTC_VALID_S 1577836800UL
+// Poids d'une nouvelle mesure dans les moyennes glissantes
+#define TRACK_ALPHA 0.2f
+
+IntervalScheduler::IntervalScheduler(const IntervalConfig &config)
+    : _config(config)
+{
+    reset();
+}
+
+void IntervalScheduler::reset()
+{
+    _state.weight_mean = NAN;
+    _state.weight_var = 0;
+    _state.temp_mean = NAN;
+    _state.temp_var = 0;
+    _state.ext_mean = NAN;
+    _state.clock = 0;
+    _state.period_ms = _config.base_ms;
+    _state.wait_ms = 0;
+}
+
+void IntervalScheduler::provision(uint32_t now)
+{
+    if (now >= RTC_VALID_S && now > _state.clock) {
+        _state.clock = now;
+    }
+}
+
+bool IntervalScheduler::due(uint32_t wake_ms)
+{
+    if (_state.clock != 0) {
+        _state.clock += (wake_ms + 500) / 1000;
+    }
+    _state.wait_ms = (_state.wait_ms > wake_ms) ? _state.wait_ms - wake_ms : 0;
+    // Au réveil le plus proche de la période demandée
+    return _state.wait_ms <= wake_ms / 2;
+}
+
+uint32_t IntervalScheduler::update(float battery_v, float weight, float temp_int,
+                                   float temp_ext, time_t now)
+{
+    if ((uint32_t)now >= RTC_VALID_S) {
+        _state.clock = (uint32_t)now;
+    }
+    track(weight, _state.weight_mean, _state.weight_var);
+    track(temp_int, _state.temp_mean, _state.temp_var);
+    if (!isnan(temp_ext)) {
+        _state.ext_mean = isnan(_state.ext_mean) ? temp_ext
+                          : _state.ext_mean + TRACK_ALPHA * (temp_ext - _state.ext_mean);
+    }
+
+    float period = _config.base_ms;
+    if (quiet()) {
+        period *= _config.quiet_factor;
+    }
+
+    // Activité : écart type ramené à son seuil, le plus fort des deux
+    float activity = sqrtf(_state.weight_var) / _config.weight_step;
+    float temp_activity = sqrtf(_state.temp_var) / _config.temp_step;
+    if (temp_activity > activity) {
+        activity = temp_activity;
+    }
+    if (activity > 1) {
+        period /= activity;
+    }
+
+    // Pile : facteur 1 pleine, max_ms/base_ms faible, période maximale en dessous
+    if (!isnan(battery_v) && battery_v < _config.battery_full_v) {
+        float x = (_config.battery_full_v - battery_v)
+                  / (_config.battery_full_v - _config.battery_low_v);
+        if (x >= 1) {
+            period = _config.max_ms;
+        } else {
+            period *= 1 + x * ((float)_config.max_ms / _config.base_ms - 1);
+        }
+    }
+
+    if (period < _config.min_ms) {
+        period = _config.min_ms;
+    }
+    if (period > _config.max_ms) {
+        period = _config.max_ms;
+    }
+    _state.period_ms = (uint32_t)period;
+    _state.wait_ms = _state.period_ms;
+    return _state.period_ms;
+}
+
+void IntervalScheduler::track(float x, float &mean, float &var)
+{
+    if (isnan(x)) {
+        return;
+    }
+    if (isnan(mean)) {
+        mean = x;
+        var = 0;
+        return;
+    }
+    float d = x - mean;
+    mean += TRACK_ALPHA * d;
+    var = (1 - TRACK_ALPHA) * (var + TRACK_ALPHA * d * d);
+}
+
+bool IntervalScheduler::quiet() const
+{
+    if (!isnan(_state.ext_mean) && _state.ext_mean < _config.cold_c) {
+        return true;
+    }
+    if (_state.clock == 0) {
+        return false;
+    }
+    int hour = (_state.clock / 3600) % 24;
+    if (_config.night_start_h <= _config.night_end_h) {
+        return hour >= _config.night_start_h && hour < _config.night_end_h;
+    }
+    return hour >= _config.night_start_h || hour < _config.night_end_h;
+}
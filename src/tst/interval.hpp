@@ -0,0 +1,98 @@
+#ifndef __INTERVAL_HPP__
+#define __INTERVAL_HPP__
+#include <stdint.h>
+#include <time.h>
+
+/* Période adaptative du cycle de mesure
+ *
+ * Partant de la période nominale, chaque cycle la recalcule :
+ * - pile faible : allongée jusqu'à max_ms à battery_low_v ;
+ * - nuit, ou colonie au repos par temps froid (hiver) : allongée ;
+ * - poids ou température qui varient : raccourcie, d'autant plus que
+ *   leur écart type récent dépasse weight_step et temp_step.
+ * Le résultat est borné à [min_ms, max_ms].
+ *
+ * Moyenne et variance sont des moyennes glissantes exponentielles, en
+ * mémoire constante. L'heure est celle de la RTC si elle a été réglée,
+ * sinon celle donnée à provision(), l'heure de compilation par exemple ;
+ * la carte étant mise hors tension entre deux cycles, elle est ensuite
+ * estimée en ajoutant la période de chaque réveil. Elle dérive comme
+ * l'oscillateur du TPL5110 et s'arrête pendant un changement de piles :
+ * une reprogrammation la recale. Sans heure connue, le critère de nuit
+ * est ignoré.
+ *
+ * Avec le TPL5110 la période matérielle est fixe : une période plus
+ * longue est obtenue en sautant des réveils (due()).
+ */
+
+struct IntervalConfig {
+    uint32_t base_ms;           // période nominale
+    uint32_t min_ms;
+    uint32_t max_ms;
+    float battery_low_v;        // période maximale à cette tension
+    float battery_full_v;       // période nominale au-dessus
+    float weight_step;          // écart type significatif du poids (g)
+    float temp_step;            // et de la température (°C)
+    float cold_c;               // colonie au repos sous cette température extérieure
+    uint8_t night_start_h;      // nuit, heures locales
+    uint8_t night_end_h;
+    float quiet_factor;         // allongement la nuit ou au froid
+};
+
+// État sauvegardable tel quel entre deux mises sous tension
+struct IntervalState {
+    float weight_mean;          // NaN avant la première mesure
+    float weight_var;
+    float temp_mean;
+    float temp_var;
+    float ext_mean;             // température extérieure moyenne
+    uint32_t clock;             // heure estimée (s), 0 si inconnue
+    uint32_t period_ms;         // période choisie au dernier cycle
+    uint32_t wait_ms;           // reste à attendre avant le prochain cycle
+};
+
+class IntervalScheduler
+{
+public:
+    IntervalScheduler(const IntervalConfig &config);
+
+    // Oublie l'historique, période nominale
+    void reset(void);
+
+    /* Heure connue par ailleurs (s, heure locale), retenue si elle est
+     * plus récente que l'heure estimée */
+    void provision(uint32_t now);
+
+    /** Réveil matériel après wake_ms : avance l'heure estimée
+     * @return true si un cycle de mesure est dû
+     */
+    bool due(uint32_t wake_ms);
+
+    /** Ajoute les mesures du cycle et calcule la prochaine période
+     * @param battery_v tension de la pile, NaN si inconnue
+     * @param weight poids, NaN si absent
+     * @param temp_int température dans la ruche, NaN si absente
+     * @param temp_ext température extérieure, NaN si absente
+     * @param now heure RTC, ignorée si elle n'a jamais été réglée
+     * @return période jusqu'au prochain cycle en ms
+     */
+    uint32_t update(float battery_v, float weight, float temp_int, float temp_ext,
+                    time_t now);
+
+    uint32_t period_ms(void) const { return _state.period_ms; }
+    // Heure estimée, 0 si inconnue
+    uint32_t clock(void) const { return _state.clock; }
+
+    // Sauvegarde et restauration de l'état
+    const IntervalState &state(void) const { return _state; }
+    void restore(const IntervalState &state) { _state = state; }
+
+private:
+    const IntervalConfig &_config;
+    IntervalState _state;
+
+    static void track(float x, float &mean, float &var);
+    bool quiet(void) const;
+};
+
+#endif
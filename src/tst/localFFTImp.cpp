@@ -1,45 +1,131 @@
 #include "localFFTImp.hpp"
+#include "adcDma.hpp"
+#include "spscRing.hpp"
 #include "mbed.h"
 
 
-// Indice de parcours
-int i = 0;
-// Entrée du micro
-AnalogIn micro_bee(A0);
-//Tick pour capture sonore
-LowPowerTicker sampler;
+// Bandes des descripteurs acoustiques, en Hz
+const Features::Band audio_bands[AUDIO_BANDS_NR] = {
+    {  100,  300 },     // ventilation, bourdonnement grave
+    {  300,  600 },     // bourdonnement de la colonie
+    {  600, 1000 },
+    { 1000, 2000 },
+};
 
-//Mutex pour assurer l'unicité de la lecture et sauvegarde des valeurs
-Mutex read_mutex;
+#if FFT_USE_GOERTZEL
+// Filtres de Goertzel, alimentés en interruption
+Fft goertzel;
+#else
+// Échantillons sonores
+fft_sample_t samples[FFT_LEN*2];
+#endif
 
-void microRead()
-{
-    // Function to protect read() of AnalogIn with thread and mutex
-    while(1) {
-        read_mutex.lock();
-        samples[i] = 1024*micro_bee.read(); // 1024 : ADC of the sound sensor
-        read_mutex.unlock();
-        ThisThread::sleep_for(1/SAMPLING_FREQ);    // in seconds
-    }
-}
+// Sorties du décimateur par moitié de tampon DMA
+#define DECIM_OUT (ADC_BLOCK/DECIMATION)
+static_assert((FFT_LEN*2) % DECIM_OUT == 0, "ADC_BLOCK/DECIMATION must divide FFT_LEN*2");
+static_assert(ADC_BLOCK >= DECIM_TAPS-1, "ADC_BLOCK shorter than the filter");
 
+// Tampon ping-pong du DMA : deux blocs de ADC_BLOCK valeurs 12 bits
+static uint16_t adc_buffer[ADC_BLOCK*2];
+// Entrée du micro, échantillonnée par TIM6 + DMA, moyennée par l'ADC
+static AdcDma micro_bee(A0, adc_buffer, ADC_BLOCK, SAMPLING_FREQ*DECIMATION,
+                        ADC_OVERSAMPLING);
+// Filtre anti-repliement et décimation, coefficients calculés à la compilation
+typedef Mikami::LowPassTable<int16_t, DECIM_TAPS, DECIMATION> AntiAliasTable;
+static AudioDsp::FirDecimatorQ15<DECIM_TAPS, DECIMATION, ADC_BLOCK>
+        anti_alias(AntiAliasTable::H.data());
+static int16_t decim_in[ADC_BLOCK], decim_out[DECIM_OUT];
+static fft_sample_t decim_block[DECIM_OUT];
+// Blocs ignorés le temps que l'état du filtre soit renouvelé
+static uint8_t warmup = 0;
 
-void sampling_interrup()
+#if !FFT_USE_GOERTZEL
+/* Sortie du décimateur vers le thread : l'interruption pousse un bloc
+ * par moitié de tampon DMA, le thread les vide dans samples[] quand il
+ * teste samplingDone(), toutes les 20 ms (4 blocs de marge) */
+#define AUDIO_RING_LEN 256
+static_assert(AUDIO_RING_LEN >= 4*DECIM_OUT, "AUDIO_RING_LEN holds less than 4 blocks");
+static SpscRing<fft_sample_t, AUDIO_RING_LEN> audio_ring;
+#endif
+// Côté thread : échantillons recopiés dans samples et blocs perdus vus
+static uint16_t filled = 0;
+static uint16_t dropped = 0;
+
+/* Appelée en interruption à chaque moitié de tampon pleine :
+ * le bloc est filtré et décimé pendant que le DMA remplit l'autre moitié */
+static void frameReady(const uint16_t *frame, uint16_t len)
 {
-    i++;
-    if (i >= FFT_LEN*2) {
-        sampler.detach();
+    // 12 bits centrés sur 0, 3 bits de marge pour les dépassements du filtre
+    for (int n = 0; n < len; n++) {
+        decim_in[n] = ((int16_t)frame[n] - 2048) * 8;
+    }
+    anti_alias.Process(decim_in, decim_out);
+    if (warmup > 0) {
+        warmup--;
+        return;
+    }
+
+    for (int n = 0; n < DECIM_OUT; n++) {
+#if FFT_SAMPLE_BITS
+        decim_block[n] = decim_out[n] >> 3;  // valeur ADC centrée sur 0
+#else
+        decim_block[n] = decim_out[n] * (1.0f/8 * 1024/4096);  // centrée sur 0, échelle de 1024*AnalogIn::read()
+#endif
     }
+#if FFT_USE_GOERTZEL
+    // Au-delà de FFT_LEN échantillons, les blocs sont ignorés
+    goertzel.Push(decim_block, DECIM_OUT);
+#else
+    // File pleine : bloc perdu, le thread recommence sa fenêtre
+    audio_ring.push(decim_block, DECIM_OUT);
+#endif
 }
 
 void samplingBegin()
 {
-    // Reset sample buffer position and start callback at the sampling frequency
-    i = 0;
-    sampler.attach_us(&sampling_interrup, 1000000/SAMPLING_FREQ);   // ttes les 1 sec
+    // Remise à zéro et lancement de l'acquisition à SAMPLING_FREQ
+#if FFT_USE_GOERTZEL
+    goertzel.Reset();
+#else
+    audio_ring.reset();
+#endif
+    filled = 0;
+    dropped = 0;
+    warmup = 1;
+    micro_bee.attach(frameReady);
+    micro_bee.start();
 }
 
 bool samplingDone()
 {
-    return i >= FFT_LEN*2;
+#if FFT_USE_GOERTZEL
+    if (filled < FFT_LEN) {
+        filled = goertzel.Count();
+        if (filled >= FFT_LEN) {
+            samplingStop();
+        }
+    }
+    return filled >= FFT_LEN;
+#else
+    if (filled < FFT_LEN*2) {
+        // Un bloc perdu rompt la continuité : fenêtre reprise à zéro
+        uint16_t lost = audio_ring.dropped();
+        if (lost != dropped) {
+            dropped = lost;
+            filled = 0;
+        }
+        filled += audio_ring.pop(samples + filled, FFT_LEN*2 - filled);
+        if (filled >= FFT_LEN*2) {
+            samplingStop();
+        }
+    }
+    return filled >= FFT_LEN*2;
+#endif
+}
+
+void samplingStop()
+{
+    // Seul le thread arrête l'acquisition, hors erreur DMA
+    CriticalSectionLock lock;
+    micro_bee.stop();
 }
@@ -1,6 +1,10 @@
 #ifndef __LOCAL_FFT_IMP_HH__
 #define __LOCAL_FFT_IMP_HH__
-#include "rtos.h"
+#include "mbed.h"
+#include "fftReal.hpp"
+#include "goertzel.hpp"
+#include "welch.hpp"
+#include "audioFeatures.hpp"
 
 // Longueur de FFT
 #define FFT_LEN 256
@@ -9,20 +13,89 @@
   Fréquence max à échantillonner 2kHz*/
 #define SAMPLING_FREQ 4000
 
+/* Chaîne anti-repliement entre l'ADC et la FFT
+ * L'ADC est déclenché à SAMPLING_FREQ*DECIMATION*ADC_OVERSAMPLING :
+ * - le suréchantillonneur matériel moyenne ADC_OVERSAMPLING conversions
+ * - un FIR Q15 de DECIM_TAPS coefficients (en flash) ramène ensuite
+ *   le signal à SAMPLING_FREQ, bloc par bloc sur chaque moitié du
+ *   tampon DMA de ADC_BLOCK échantillons */
+#define ADC_OVERSAMPLING 2
+#define DECIMATION 2
+#define DECIM_TAPS 63
+#define ADC_BLOCK 128
 
-// Échantillons sonores
-static float samples[FFT_LEN*2];
-// Thread pour capture sonore          
-static Thread thread1;
 
-// Fonction d'interruption pour l'échantillonnage
-void sampling_interrup();
-/* Associe la fonction d'interruption et 
- * initialise les différentes variables nécessaires */
+/* Type des échantillons de la FFT, choisi à la compilation
+ * 0 : float, 15 : virgule fixe Q15, 31 : virgule fixe Q31
+ * En virgule fixe les valeurs 12 bits de l'ADC sont utilisées
+ * directement (centrées sur 0) sans passer par le FPU */
+#ifndef FFT_SAMPLE_BITS
+#define FFT_SAMPLE_BITS 0
+#endif
+
+#if FFT_SAMPLE_BITS == 15
+typedef int16_t fft_sample_t;
+#elif FFT_SAMPLE_BITS == 31
+typedef int32_t fft_sample_t;
+#else
+typedef float fft_sample_t;
+#endif
+
+/* Analyse fréquentielle
+ * 0 : FFT complète de FFT_LEN points
+ * 1 : filtres de Goertzel sur les seules raies suivies, même sortie
+ *     (raie k = k*SAMPLING_FREQ/FFT_LEN Hz), alimentés par
+ *     l'interruption à chaque bloc décimé : ni samples[] ni FFT */
+#ifndef FFT_USE_GOERTZEL
+#define FFT_USE_GOERTZEL 0
+#endif
+
+// FFT et type de ses résultats pour le type d'échantillon choisi
+#if FFT_USE_GOERTZEL
+// Raies suivies : 344 Hz, 453 Hz, 515 Hz et 1 kHz
+typedef Goertzel<fft_sample_t, FFT_LEN, 22, 29, 33, 64> Fft;
+#else
+typedef Mikami::FftRealN<fft_sample_t, FFT_LEN> Fft;
+#endif
+typedef Fft::Cplx fft_bin_t;
+
+/* Estimation spectrale par la méthode de Welch : trames de FFT_LEN
+ * points recouvrantes à 50 % dans samples[], fenêtre de Hann,
+ * puissance moyennée raie par raie */
+typedef Welch<fft_sample_t, FFT_LEN, Mikami::WINDOW_HANN> Spectrum;
+
+/* Descripteurs acoustiques extraits du spectre moyen : énergie par
+ * bande, centroïde, pic interpolé et RMS */
+#define AUDIO_BANDS_NR 4
+typedef AudioFeatures<FFT_LEN, AUDIO_BANDS_NR> Features;
+extern const Features::Band audio_bands[AUDIO_BANDS_NR];
+
+/* Facteur ramenant une amplitude de la FFT à l'échelle historique
+ * 1024*AnalogIn::read(), soit valeur ADC / 4 */
+#if FFT_SAMPLE_BITS
+#define FFT_SAMPLE_UNIT 0.25f
+#else
+#define FFT_SAMPLE_UNIT 1.0f
+#endif
+
+#if FFT_USE_GOERTZEL
+// Filtres des raies suivies, FFT_LEN échantillons par acquisition
+extern Fft goertzel;
+#else
+// Échantillons sonores (remplis bloc par bloc par le décimateur)
+extern fft_sample_t samples[FFT_LEN*2];
+#endif
+
+/* Lance l'acquisition DMA des FFT_LEN*2 échantillons (FFT_LEN pour
+ * Goertzel), le coeur peut dormir pendant ce temps */
 void samplingBegin();
-/* Indique l'état de l'échantillonnage */
+/* Recopie dans samples les blocs décimés en attente et indique si les
+ * FFT_LEN*2 échantillons sont là (avec Goertzel, si les filtres ont vu
+ * FFT_LEN échantillons), l'acquisition est alors arrêtée
+ * À appeler depuis le thread, périodiquement pendant l'acquisition */
 bool samplingDone();
-/* Fonction d'échantillonnage */
-void microRead();
+/* Arrête une acquisition inachevée (cycle abandonné), ce qui rend
+ * le deepsleep au gestionnaire de sommeil */
+void samplingStop();
 
-#endif
\ No newline at end of file
+#endif
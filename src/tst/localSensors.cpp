@@ -0,0 +1,48 @@
+#include "localSensors.hh"
+
+#if ONEWIRE_TRANSPORT == ONEWIRE_UART
+#if DEBUG
+#error "USART2 : le bus des sondes et la liaison de debug sont sur PA2"
+#endif
+// Bus OneWire pour DS1820, USART2 en semi-duplex
+static OneWireBus oneWire(A7);
+#else
+// Bus OneWire pour DS1820
+static OneWireBus oneWire(D2);
+#endif
+// DHT 22 intérieur
+static Dht22 dhtI(D3);
+// DHT 22 extérieur
+static Dht22 dhtE(D4);
+// Capteur de poids
+static HX711 hx711(D12, D11);
+
+DhtSensor dhtInt("dhtI", dhtI);
+DhtSensor dhtExt("dhtE", dhtE);
+Hx711Sensor balance("poids", hx711, true);     // cellule montée à l'envers
+// 11 bits : 0,125 °C en 375 ms, couverts par la mise en route du HX711
+Ds1820Sensor sondes("sondes", oneWire, 11);
+
+SensorRegistry sensors;
+
+// Sondes posées dans la ruche, dans l'ordre DROITE, GAUCHE
+static const uint8_t addrs[SENSORS_NR][8] = {
+    // Sonde 0
+    {0x28,0x8e,0x2d,0x35,0xc,0x0,0x0,0x81},
+    // Sonde 1
+    {0x28,0x34,0xab,0x33,0xc,0x0,0x0,0x17}
+};
+
+int sensorsBegin()
+{
+    // Aucune adresse sauvegardée : position des sondes connues
+    if (sondes.probes().count() == 0) {
+        for (int i = 0; i < SENSORS_NR; i++)
+            sondes.probes().add(addrs[i]);
+    }
+    sensors.add(&sondes);
+    sensors.add(&balance);
+    sensors.add(&dhtExt);
+    sensors.add(&dhtInt);
+    return sensors.begin();
+}
@@ -1,23 +1,29 @@
 #ifndef __LOCAL_SENSORS_HH__
 #define __LOCAL_SENSORS_HH__
-// SONDES 
+#include "sensorDrivers.hpp"
+
+/* Capteurs de la ruche
+ * Les adresses des sondes DS1820 posées sont connues (localSensors.cpp),
+ * puis gardées en KVStore : une sonde remplacée reprend l'indice de
+ * l'ancienne, sans recompiler */
+
+// SONDES
 #define SENSORS_NR 2
 #define DROITE 0
 #define GAUCHE 1
 
-uint8_t addrs[SENSORS_NR][8] =
+// DHT 22 intérieur et extérieur
+extern DhtSensor dhtInt;
+extern DhtSensor dhtExt;
+// Capteur de poids
+extern Hx711Sensor balance;
+// Sondes de température étanches
+extern Ds1820Sensor sondes;
+
+// Liste parcourue par le cycle de mesure
+extern SensorRegistry sensors;
 
-                 // Sonde 0
-    {   {0x28,0x8e,0x2d,0x35,0xc,0x0,0x0,0x81},
-        // Sonde 1
-        {0x28,0x34,0xab,0x33,0xc,0x0,0x0,0x17}
-    };
-    /*,
-    // Sonde 2
-    {0x28,0xb0,0xde,0x34,0xc,0x0,0x0,0x18},
-    // Sonde 3
-    {0x28,0xf4,0xe3,0x31,0xc,0x0,0x0,0x58},
-    // Sonde 4
-    {0x28,0x6f,0x68,0x34,0xc,0x0,0x0,0x2b}};*/
+// Construit la liste et détecte les capteurs présents
+int sensorsBegin();
 
 #endif 
@@ -1,10 +1,7 @@
 // headers de bibliothèques C
-#include "DS1820.h"
 #include "mbed.h"
-#include "DHT.h"
 #include "WakeUp.h" 
 #include "rtos.h"   // lib thread & mutex
-#include "HX711.h"   // lib pour le capteur de poids
 
 // headers de bibliothèques C++
 #include <LowPowerTicker.h>
@@ -14,9 +11,22 @@
 // header spécifiques à l'implémentation
 #include "localFFTImp.hpp" 
 #include "localSensors.hh"
+#include "acquisition.hpp"
+#include "telemetrySchema.hpp"
+#include "aggregator.hpp"
+#include "flashLog.hpp"
+#include "powerCycle.hpp"
+#include "battery.hpp"
+#include "interval.hpp"
+#include "profile.hpp"
+#include "kvstore_global_api.h"
 
 //Temps minimum pour garantir l'envoi de données par Sigfox
 #define LPWAN_LIMIT 6000
+// Durée d'émission d'un octet à 9600 bauds, avec marge
+#define SIGFOX_BYTE_US 1200
+// Période du cycle de mesure, celle du TPL5110
+#define CYCLE_PERIOD_MS 360000
 
 // Liaison sigfox
 Serial sigfox(D1, D0); // tx, rx
@@ -26,185 +36,468 @@ Serial sigfox(D1, D0); // tx, rx
 Serial pc(USBTX, USBRX); // tx, rx
 #endif
 
-// Bus OneWire pour DS1820
-OneWire     oneWire(D2);
-// Sondes de température étanches
-DS1820*     ds1820[SENSORS_NR]; 
-// DHT 22 intérieur
-DHT dhtI(D3, DHT22);
-//DHT 22 intérieur
-DHT dhtE(D4, DHT22);
 // Pin pour PM
 DigitalOut done(D5);
-// Capteur de poids
-HX711 Balance(D12,D11);
+// Enchaînement acquisition, traitement, émission, sommeil
+PowerCycle power(done, CYCLE_PERIOD_MS);
 
-/* Variables représentant
- * expAmp : exposant 10 de l'amplification de la fréquence mesurée
- * expF : exposant 10 de la hauteur fréquence
- */
-uint8_t expAmp = 0, expF =0;
+// Codage des mesures dans la trame Sigfox
+TelemetryCodec telemetry(HIVE_SCHEMA, HIVE_FIELDS_NR);
+// Référence des trames différentielles, gardée hors tension
+#define TELEMETRY_KEY "/kv/telemetry"
+
+/* Envoi sur événement : seuil d'écart avec la dernière valeur envoyée
+ * et statistique envoyée pour chaque champ de HIVE_SCHEMA */
+static const AggregateRule HIVE_RULES[HIVE_FIELDS_NR] = {
+    {   1.0f, AggregateRule::MEAN },    // tempExt
+    {   1.0f, AggregateRule::MEAN },    // tempInt
+    {   5.0f, AggregateRule::MEAN },    // humExt
+    {   5.0f, AggregateRule::MEAN },    // humInt
+    {   0.5f, AggregateRule::MEAN },    // probeLeft
+    {   0.5f, AggregateRule::MEAN },    // probeRight
+    { 500.0f, AggregateRule::LAST },    // weight : essaimage, récolte
+    {  50.0f, AggregateRule::LAST },    // peakFreq
+    {   6.0f, AggregateRule::MAX },     // peakLevel
+    {   6.0f, AggregateRule::MEAN },    // rmsLevel
+    {   0.0f, AggregateRule::MEAN },    // centroid
+};
+// Envoi au moins toutes les heures (cycles de 6 min)
+#define HEARTBEAT_CYCLES 10
+Aggregator aggregator(HIVE_RULES, HIVE_FIELDS_NR, HEARTBEAT_CYCLES);
+// La carte est mise hors tension entre deux cycles : état en flash
+#define AGGREGATOR_KEY "/kv/aggregator"
+
+/* Historique : les mesures de chaque cycle sont journalisées en flash
+ * et renvoyées par lots dans les cycles sans envoi de l'agrégateur */
+FlashLog history;
+// Trame absolue d'un enregistrement du journal
+TelemetryCodec logCodec(HIVE_SCHEMA, HIVE_FIELDS_NR);
+TelemetryCodec historyCodec(HISTORY_SCHEMA, HISTORY_FIELDS_NR);
+// Numéro de la prochaine mesure du journal à envoyer
+#define HISTORY_KEY "/kv/history"
+#define HISTORY_BATCH_MAX 4
+
+/* Quota Sigfox de 140 messages par jour : les rapports et le profil
+ * partent toujours, l'historique seulement s'il reste de quoi couvrir
+ * les rapports du reste de la journée (un toutes les 30 min). Sa part
+ * est répartie sur la journée, avec au plus une heure d'avance */
+#define UPLINK_DAILY_MAX 140
+#define UPLINK_RESERVE 48
+#define UPLINK_AHEAD_S 3600
+struct UplinkBudget {
+    uint32_t day;               // jour de l'heure estimée
+    uint16_t used;              // messages envoyés ce jour-là
+};
+#define UPLINK_KEY "/kv/uplink"
+
+/* Période adaptative : pile, activité de la colonie, nuit et froid
+ * Avec le TPL5110, une période plus courte que la sienne n'est tenue
+ * que si la carte reste alimentée (réveil par l'alarme RTC) */
+static const IntervalConfig INTERVAL_CONFIG = {
+    CYCLE_PERIOD_MS,        // période nominale
+    CYCLE_PERIOD_MS / 3,    // 2 min pendant un essaimage
+    10 * CYCLE_PERIOD_MS,   // 1 h
+    2.2f, 2.8f,             // deux piles AA sur le 3V3
+    200.0f,                 // g, miellée ou essaimage
+    0.5f,                   // °C, régulation du couvain
+    8.0f,                   // °C, grappe d'hiver
+    21, 6,                  // nuit
+    2.0f,
+};
+IntervalScheduler interval(INTERVAL_CONFIG);
+#define INTERVAL_KEY "/kv/interval"
+Battery battery;
+
+/* Profil du cycle : durée et charge de chaque phase, résumé envoyé une
+ * fois par jour dans un cycle sans autre envoi
+ * Courants moyens sous 3,3 V d'après les datasheets */
+static const float HIVE_CURRENTS[HIVE_PHASES_NR] = {
+    2.0f,       // probes : deux DS1820 en conversion
+    1.5f,       // weight : HX711
+    1.5f,       // dhtExt
+    1.5f,       // dhtInt
+    3.0f,       // mic : préampli et ADC
+    2.0f,       // acquire : MCU en sleep à 80 MHz
+    8.0f,       // fft : MCU à 80 MHz
+    8.0f,       // encode
+    11.0f,      // store : programmation et effacement de la flash
+    18.0f,      // uart : MCU et modem en réception
+    50.0f,      // lpwan : modem en émission à 14 dBm
+    0.002f,     // sleep : mode stop 2 et RTC
+};
+static const ProfileConfig PROFILE_CONFIG = {
+    3.3f, HIVE_CURRENTS, HIVE_PHASES_NR,
+    (1UL << PHASE_FFT) | (1UL << PHASE_ENCODE) | (1UL << PHASE_STORE) | (1UL << PHASE_UART),
+};
+CycleProfile profile(PROFILE_CONFIG);
+#define PROFILE_KEY "/kv/profile"
+// Un jour de cycles de 6 min
+#define PROFILE_REPORT_CYCLES 240
+
+// Adresses des sondes DS1820
+#define PROBES_KEY "/kv/probes"
+// Sondes absentes cherchées de nouveau une fois par jour de cycles
+#define PROBES_RECHECK_CYCLES 240
+
+// Abandon des capteurs muets
+#define CYCLE_TIMEOUT_MS 2000
+
+// Ordonnancement des acquisitions
+EventQueue queue(8 * EVENTS_EVENT_SIZE);
+Acquisition cycle(queue);
+
+static void micStart()
+{
+    profile.begin(PHASE_MIC);
+    samplingBegin();
+}
+
+// Micro : le DMA s'arrête seul après FFT_LEN*2 échantillons
+static void micCollect()
+{
+    profile.end(PHASE_MIC);
+}
+
+static void sigfoxSend(const uint8_t frame[], int len)
+{
+    // Le mode stop coupe l'UART : attendre que le dernier octet soit sorti
+    DeepSleepLock lock;
+    profile.begin(PHASE_UART);
+    sigfox.printf("AT$SF=");
+    for (int i = 0; i < len; i++)
+        sigfox.printf("%02X", frame[i]);
+    sigfox.printf("\r\n");
+    wait_us(SIGFOX_BYTE_US);
+    profile.end(PHASE_UART);
+}
+
+/* Heure de compilation en s depuis 1970, heure locale de la machine de
+ * build : première heure connue de la carte, sans RTC sauvegardée */
+static uint32_t buildTime()
+{
+    static const char months[] = "JanFebMarAprMayJunJulAugSepOctNovDec";
+    const char *date = __DATE__;        // "Oct 16 2026"
+    const char mon[4] = { date[0], date[1], date[2], 0 };
+    int month = (strstr(months, mon) - months) / 3 + 1;
+    int day = atoi(date + 4);
+    int year = atoi(date + 7);
+    int h, m, sec;
+    sscanf(__TIME__, "%d:%d:%d", &h, &m, &sec);
+
+    // Jours depuis le 1er janvier 1970, années commençant en mars
+    if (month <= 2)
+        year--;
+    int era = year / 400;
+    int yoe = year - era * 400;
+    int doy = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    int doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    uint32_t days = era * 146097 + doe - 719468;
+    return days * 86400 + h * 3600 + m * 60 + sec;
+}
+
+/* Envoie le lot de mesures du journal commençant à sent, avancé au
+ * numéro de la prochaine mesure à envoyer
+ * Retourne true si un lot est parti */
+static bool historyUpload(uint32_t &sent)
+{
+    LogRecord records[HISTORY_BATCH_MAX];
+    float hive[HIVE_FIELDS_NR];
+    float batch[HISTORY_BATCH_MAX * HISTORY_FIELDS_NR];
+    uint8_t frame[TELEMETRY_FRAME_MAX];
+    int samples = historyCodec.batchSamples();
+    MBED_ASSERT(samples <= HISTORY_BATCH_MAX);
+
+    // Mesures écrasées avant d'avoir été envoyées : perdues
+    if (sent < history.first())
+        sent = history.first();
+    if (history.next() - sent < (uint32_t)samples)
+        return false;
+
+    for (int i = 0; i < samples * HISTORY_FIELDS_NR; i++)
+        batch[i] = NAN;
+    int n = history.read(sent, records, samples);
+    for (int k = 0; k < n; k++) {
+        uint32_t idx = records[k].seq - sent;
+        logCodec.reset();
+        if (idx >= (uint32_t)samples
+                || logCodec.decode(records[k].frame, TELEMETRY_FRAME_MAX, hive) != TelemetryCodec::TELEMETRY_OK)
+            continue;
+        batch[idx*HISTORY_FIELDS_NR + HISTORY_WEIGHT]     = hive[HIVE_WEIGHT];
+        batch[idx*HISTORY_FIELDS_NR + HISTORY_TEMP_INT]   = hive[HIVE_TEMP_INT];
+        batch[idx*HISTORY_FIELDS_NR + HISTORY_PEAK_LEVEL] = hive[HIVE_PEAK_LEVEL];
+    }
+    sigfoxSend(frame, historyCodec.encodeBatch(sent & 0xFF, batch, frame));
+    sent += samples;
+    return true;
+}
 
 int main()
 {
-    // ~~~~~~ Variables Température ~~~~~~~
-    float tmp = 0,mod;
-    int sensors_found = 0,  result = 0;
+    float mod = 0;
+    // Trame Sigfox
+    float values[HIVE_FIELDS_NR];
+    uint8_t frame[TELEMETRY_FRAME_MAX];
+    int len;
     
-    int i = 0,j = 0;
-    uint8_t  
-    // Températures 
-        tcI = 0, tcE = 0,
-    // Humidités
-        thI = 0, thE = 0;
+    int i = 0;
 
     // Résultats de mesures de température
-    float sonde[SENSORS_NR];
-
-    // ~~~~~~ Variables Poids ~~~~~~~
+    float sonde[SENSORS_NR] = {0};
+    // Poids
     float valeur_poids;
 
     // ~~~~~~ Variables FFT ~~~~~~~
-   // float tabFFT[5] = {0};    // 5 frequencies, init to 0
-    int idxFFT = 0;
-    bool fill_FFT_tab = 0;   // set to false
-    int max1 = 1;   // avoid DC value (0 Hz)
     float valHz = 0;
     // CONFIG FFT
-    Mikami::Complex fft_bins[FFT_LEN];
-    Mikami::FftReal fft((int16_t)FFT_LEN);
-
-#if DEBUG
+#if FFT_USE_GOERTZEL
+    fft_bin_t fft_bins[FFT_LEN/2+1];
+#else
+    Spectrum spectrum;
+    Features features(audio_bands, SAMPLING_FREQ);
+#endif
 
-    // D"tection des sondes  pour obtention adresses
-    // mettre debug à 1 dans DS1820.cpp
-    for(i = 0; i < SENSORS_NR; i++) {
-        ThisThread::sleep_for(1000);
-        if(!ds1820[i]->begin()) {
-            delete ds1820[i];
-            break;
-        }
+    // Réveil du TPL5110 avant la fin de la période choisie : rien à mesurer
+    IntervalState interval_saved;
+    size_t interval_size = 0;
+    if (kv_get(INTERVAL_KEY, &interval_saved, sizeof(interval_saved), &interval_size) == MBED_SUCCESS
+            && interval_size == sizeof(interval_saved))
+        interval.restore(interval_saved);
+    // Heure perdue à la coupure : estimée depuis la compilation
+    interval.provision(buildTime());
+    // Sans TPL5110, sleep() rend la main après CYCLE_PERIOD_MS
+    while (!interval.due(CYCLE_PERIOD_MS)) {
+        kv_set(INTERVAL_KEY, &interval.state(), sizeof(IntervalState), 0);
+        power.sleep();
     }
-    sensors_found = i;
-    pc.printf("Found %d sensors.\r\n", sensors_found);
 
-#else
-    // Connaissance des sondes en dur
-    for(i = 0 ; i < SENSORS_NR ; i ++ ) {
-        ds1820[i] = new DS1820(&oneWire);
-        for(j=0; j<8; j++) {
-            ds1820[i]->addr[j] = addrs[i][j];
-            ds1820[i]->present = true;
-        }
-    }
-    sensors_found = SENSORS_NR;
+    // Fenêtre d'agrégation du cycle précédent
+    AggregatorState saved;
+    size_t saved_size = 0;
+    if (kv_get(AGGREGATOR_KEY, &saved, sizeof(saved), &saved_size) == MBED_SUCCESS
+            && saved_size == sizeof(saved))
+        aggregator.restore(saved);
+
+    // Dernière trame envoyée, référence de la suivante
+    TelemetryState telemetry_saved;
+    size_t telemetry_size = 0;
+    if (kv_get(TELEMETRY_KEY, &telemetry_saved, sizeof(telemetry_saved), &telemetry_size) == MBED_SUCCESS
+            && telemetry_size == sizeof(telemetry_saved))
+        telemetry.restore(telemetry_saved);
+
+    // Journal en flash et position de son envoi
+    uint32_t history_sent = 0;
+    if (history.init() != 0)
+        error("FlashLog init\r\n");
+    kv_get(HISTORY_KEY, &history_sent, sizeof(history_sent), NULL);
+
+    // Messages déjà envoyés dans la journée
+    UplinkBudget budget = { 0, 0 };
+    size_t budget_size = 0;
+    if (kv_get(UPLINK_KEY, &budget, sizeof(budget), &budget_size) != MBED_SUCCESS
+            || budget_size != sizeof(budget))
+        budget.day = budget.used = 0;
+
+    // Profil des cycles précédents
+    ProfileState profile_saved;
+    size_t profile_size = 0;
+    if (kv_get(PROFILE_KEY, &profile_saved, sizeof(profile_saved), &profile_size) == MBED_SUCCESS
+            && profile_size == sizeof(profile_saved))
+        profile.restore(profile_saved);
+
+    // Adresses des sondes trouvées aux démarrages précédents
+    Ds1820BusState probes_saved;
+    size_t probes_size = 0;
+    if (kv_get(PROBES_KEY, &probes_saved, sizeof(probes_saved), &probes_size) == MBED_SUCCESS
+            && probes_size == sizeof(probes_saved))
+        sondes.probes().restore(probes_saved);
+    // Compteur de cycles gardé par le journal
+    if (history.next() % PROBES_RECHECK_CYCLES == 0)
+        sondes.probes().recheck();
+
+    // Détection des capteurs : sondes vérifiées, recherchées si l'une manque
+    sensorsBegin();
+    if (sondes.probes().changed())
+        kv_set(PROBES_KEY, &sondes.probes().state(), sizeof(Ds1820BusState), 0);
+#if DEBUG
+    pc.printf("Found %d sensors.\r\n", sondes.count());
 #endif
 
-    // Lance l'échantillonage
-    thread1.start(microRead);
+    // Cycle de mesure : toutes les conversions lentes en parallèle
+    sensors.schedule(cycle);
+    cycle.add(micStart, micCollect, 0, samplingDone, 20);
+
     while(1) {
-        samplingBegin();
-        // Récupération des données extérieures
-        if(dhtE.readData() == 0) {
-            tmp   = dhtE.ReadTemperature(CELCIUS)*2;
-            tcI = (uint8_t) tmp;
-            tmp   = dhtE.ReadHumidity()*2;
-            thI = (uint8_t) tmp;
-        }
-        // ~~~~~~~ PARTIE CAPTEUR DE POIDS ~~~~~~~
-        Balance.powerUp();
-        valeur_poids = Balance.getGram();      // on récupère la valeur
-        valeur_poids = valeur_poids *(-1.000);
+        power.enter(PowerCycle::ACQUIRE);
+        profile.cycle();
+        // Carte restée alimentée : sommeil du cycle précédent
+        if (power.elapsed_ms(PowerCycle::SLEEP) > 0)
+            profile.add(PHASE_SLEEP, power.elapsed_ms(PowerCycle::SLEEP) * 1000);
+        profile.begin(PHASE_ACQUIRE);
+        // Rend la main au plus tard après le capteur le plus lent
+        cycle.run(CYCLE_TIMEOUT_MS);
+        // Cycle abandonné : rien ne doit empêcher le deepsleep
+        samplingStop();
+        sensors.powerDown();
+        profile.end(PHASE_ACQUIRE);
+        // Capteurs relevés, du lancement à la mise en veille
+        if (sondes.elapsed_us())
+            profile.add(PHASE_PROBES, sondes.elapsed_us());
+        if (balance.elapsed_us())
+            profile.add(PHASE_WEIGHT, balance.elapsed_us());
+        if (dhtExt.elapsed_us())
+            profile.add(PHASE_DHT_EXT, dhtExt.elapsed_us());
+        if (dhtInt.elapsed_us())
+            profile.add(PHASE_DHT_INT, dhtInt.elapsed_us());
+
+        power.enter(PowerCycle::PROCESS);
+        // L'ADC est libre une fois l'acquisition arrêtée
+        float battery_v = battery.read();
+
+        valeur_poids = balance.value(0);
+        for(i = 0; i < SENSORS_NR && i < sondes.count(); i++)
+            sonde[i] = sondes.value(i);
         #if DEBUG
+            pc.printf("DHT Exterieur : temp = %.1f , hum = %.1f\r\n", dhtExt.value(0), dhtExt.value(1));
+            pc.printf("DHT Interieur : temp = %.1f , hum = %.1f\r\n", dhtInt.value(0), dhtInt.value(1));
             pc.printf("\nPoids :%.2f\r\n", valeur_poids);        // Affichage du poids sur Putty
+            for(i = 0; i < sondes.count(); i++)
+                pc.printf("temp[%d] = %3d%cC\r\n", i,  (int)(100*sondes.value(i)), 176);
         #endif
-        Balance.powerDown();
-        
-        // ~~~~~ PARTIE FFT ~~~~~
-
-        for(i = 0; i < sensors_found; i++) {
-            ds1820[i]->startConversion();   // start temperature conversion from analog to digital
-            ThisThread::sleep_for(200);        // let DS1820s complete the temperature conversion
-            result = ds1820[i]->read(sonde[i]);
-          #if DEBUG
-            pc.printf("temp[%d] = %3d%cC\r\n", i,  (int)(100*sonde[i]), 176);     // read temperature
-          #endif
-        }
-        // Récupère température et humidité intérieures
-
-        if(dhtI.readData() == 0) {
-            tmp   = dhtI.ReadTemperature(CELCIUS)*2;
-            tcI = (uint8_t) tmp;
-            tmp   = dhtI.ReadHumidity()*2;
-            thI = (uint8_t) tmp;
-            #if DEBUG
-                pc.printf("temp DHT Extérieur = %3.1f (int) = %d , hum = %3.1f (int) = %d\r\n", c, tcE, h, thE);     // read temperature
-            #endif
-        }
 
         // La FFT est prête
         if (samplingDone()) {
+            profile.begin(PHASE_FFT);
             
             /*453 
             359-345
             1k
             515Hz*/
-            fft.Execute(samples,fft_bins);
             mod = 0;
             valHz = 29 * SAMPLING_FREQ / (FFT_LEN);
-            mod = std::abs(fft_bins[29]);
+#if FFT_USE_GOERTZEL
+            // Filtres déjà alimentés par l'interruption du DMA
+            goertzel.Result(fft_bins);
+            mod = goertzel.Abs(fft_bins[29])*FFT_SAMPLE_UNIT;
+#else
+            // Moyenne des trames recouvrantes de samples[]
+            spectrum.Execute(samples, FFT_LEN*2);
+            // Fréquence dominante trouvée en un passage sur les raies
+            features.Execute(spectrum);
+            valHz = features.Peak();
+            mod = sqrtf(features.PeakPower())*FFT_SAMPLE_UNIT;
+#endif
+            profile.end(PHASE_FFT);
             #if DEBUG
             pc.printf("\nMesures : ");
             pc.printf("\r\nAmplitude = %.2f\r\n", mod);
             pc.printf("Frequency = %.4f Hz\r\n\n", valHz);
-            pc.printf("tabFFT[%d] = %.4f Hz\n", idxFFT, tabFFT[idxFFT]);
+#if !FFT_USE_GOERTZEL
+            pc.printf("RMS = %.2f, centroide = %.1f Hz\r\n",
+                      features.Rms()*FFT_SAMPLE_UNIT, features.Centroid());
+            for (int j = 0; j < AUDIO_BANDS_NR; j++)
+                pc.printf("Bande %d = %.3f\r\n", j,
+                          features.Energy(j)*FFT_SAMPLE_UNIT*FFT_SAMPLE_UNIT);
+#endif
             #endif
-            // Initialisation des exposants
-            expAmp = 0 ;
-            expF = 0;
-            
-            
-            if(mod /10 >= 100) {
-                expAmp = 1;
-                while((mod /= 10) > 100)
-                    expAmp++;
-            }
-            
-            if(valHz /10 >= 100) {
-                expF  = 1;
-                while((valHz /= 10)> 100)
-                    expF++;
-            }
+        }
             
-            // 
-            if (idxFFT == 5)  { // wait for stabilization after switch on
-                    fill_FFT_tab = 1;
-                    idxFFT = 0; // reset idxFFT
-                }
-                idxFFT++;
+        // Mesures absentes : NaN, codées comme telles dans la trame
+        values[HIVE_TEMP_EXT]    = dhtExt.valid() ? dhtExt.value(0) : NAN;
+        values[HIVE_HUM_EXT]     = dhtExt.valid() ? dhtExt.value(1) : NAN;
+        values[HIVE_TEMP_INT]    = dhtInt.valid() ? dhtInt.value(0) : NAN;
+        values[HIVE_HUM_INT]     = dhtInt.valid() ? dhtInt.value(1) : NAN;
+        values[HIVE_PROBE_LEFT]  = (sondes.count() > GAUCHE) ? sonde[GAUCHE] : NAN;
+        values[HIVE_PROBE_RIGHT] = (sondes.count() > DROITE) ? sonde[DROITE] : NAN;
+        values[HIVE_WEIGHT]      = balance.valid() ? valeur_poids : NAN;
+        values[HIVE_PEAK_FREQ]   = valHz;
+        values[HIVE_PEAK_LEVEL]  = (mod > 0) ? 20*log10f(mod) : NAN;
+#if FFT_USE_GOERTZEL
+        values[HIVE_RMS_LEVEL]   = NAN;
+        values[HIVE_CENTROID]    = NAN;
+#else
+        values[HIVE_RMS_LEVEL]   = (features.Rms() > 0) ? 20*log10f(features.Rms()*FFT_SAMPLE_UNIT) : NAN;
+        values[HIVE_CENTROID]    = features.Centroid();
+#endif
+        profile.begin(PHASE_ENCODE);
+        aggregator.add(values);
+        logCodec.reset();
+        logCodec.encode(values, frame);
+        history.append(frame, time(NULL));
+        power.setPeriod(interval.update(battery_v, values[HIVE_WEIGHT], values[HIVE_TEMP_INT],
+                                        values[HIVE_TEMP_EXT], time(NULL)));
+        profile.end(PHASE_ENCODE);
+
+        power.enter(PowerCycle::TRANSMIT);
+        // Envoi des données si un seuil est franchi ou au heartbeat,
+        // sinon la liaison sert au profil quotidien ou à l'historique
+        // Heure estimée toujours connue : provision() au démarrage
+        if (budget.day != interval.clock() / 86400) {
+            budget.day = interval.clock() / 86400;
+            budget.used = 0;
+        }
+        uint32_t history_share = (UPLINK_DAILY_MAX - UPLINK_RESERVE)
+                                 * (interval.clock() % 86400 + UPLINK_AHEAD_S) / 86400;
+        if (history_share > UPLINK_DAILY_MAX - UPLINK_RESERVE)
+            history_share = UPLINK_DAILY_MAX - UPLINK_RESERVE;
+        uint32_t history_before = history_sent;
+        bool reported = aggregator.pending();
+        bool sent = reported;
+        if (reported) {
+            aggregator.report(values);
+            len = telemetry.encode(values, frame);
+            sigfoxSend(frame, len);
+        } else if (profile.cycles() >= PROFILE_REPORT_CYCLES) {
+            sigfoxSend(frame, profile.encode(frame));
+            profile.clear();
+            sent = true;
+        } else if (budget.used < history_share) {
+            sent = historyUpload(history_sent);
+        }
+        // Avant la coupure d'alimentation
+        profile.begin(PHASE_STORE);
+        history.flush();
+        kv_set(AGGREGATOR_KEY, &aggregator.state(), sizeof(AggregatorState), 0);
+        if (reported)
+            kv_set(TELEMETRY_KEY, &telemetry.state(), sizeof(TelemetryState), 0);
+        // Chaque écriture use le TDBStore : clés inchangées non réécrites
+        if (history_sent != history_before)
+            kv_set(HISTORY_KEY, &history_sent, sizeof(history_sent), 0);
+        if (sent) {
+            budget.used++;
+            kv_set(UPLINK_KEY, &budget, sizeof(budget), 0);
+        }
+        kv_set(INTERVAL_KEY, &interval.state(), sizeof(IntervalState), 0);
+        profile.end(PHASE_STORE);
+
+        // Le modem émet seul après la commande AT : il reste alimenté
+        if (sent) {
+            profile.begin(PHASE_LPWAN);
+            ThisThread::sleep_for(LPWAN_LIMIT);
+            profile.end(PHASE_LPWAN);
+        }
+        kv_set(PROFILE_KEY, &profile.state(), sizeof(ProfileState), 0);
+
+        #if DEBUG
+            pc.printf("Pile = %.2f V, periode = %lu s\r\n", battery_v,
+                      (unsigned long)(interval.period_ms() / 1000));
+            pc.printf("Messages du jour : %u\r\n", budget.used);
+            for (i = 0; i < PowerCycle::STATES_NR; i++)
+                pc.printf("%s : %lu ms\r\n", PowerCycle::name((PowerCycle::State)i),
+                          (unsigned long)power.elapsed_ms((PowerCycle::State)i));
+            // Sur la fenêtre du profil : durées en µs, charge en µC par cycle
+            pc.printf("Profil sur %d cycles\r\n", profile.cycles());
+            for (i = 0; i < HIVE_PHASES_NR; i++) {
+                if (profile.count(i) == 0)
+                    continue;
+                pc.printf("%s : %u x %lu us, max %lu us, %.1f uC [", HIVE_PHASE_NAMES[i],
+                          profile.count(i), (unsigned long)profile.mean_us(i),
+                          (unsigned long)profile.max_us(i), profile.charge_uc(i) / profile.cycles());
+                for (int j = 0; j < PROFILE_BUCKETS; j++)
+                    pc.printf(" %u", profile.histogram(i, j));
+                pc.printf(" ]\r\n");
             }
-            
-        // Concaténation des exposants et résultats
-        expAmp <<= 4;
-        expAmp += expF;
-        result  = ((int) mod )<< 8 ;
-        result+= (uint16_t) valHz;
-        
-        // Envoi des données
-        sigfox.printf(  "AT$SF=%02X%02X%02X%02X%04X%04X%02X%02X%04X\r\n",
-                        tcE,tcI,thE,thI,  (int)(100*sonde[GAUCHE]),
-                        (int)(100*sonde[DROITE]),(uint8_t)valeur_poids*2,
-                        expAmp,
-                        (uint16_t)result
-                     );
-
-        //Attends 6 min      */
-        thread1.terminate();
-        hal_deepsleep();
-        ThisThread::sleep_for(LPWAN_LIMIT);
-        done = 1 ;
-        // This code shall never be reached
-        ThisThread::sleep_for(360000);
-        done = 0;
+        #endif
+        // Coupure par le TPL5110, ou réveil par l'alarme RTC
+        power.sleep();
     }
 }
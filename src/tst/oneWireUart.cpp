@@ -0,0 +1,180 @@
+#include "oneWireUart.hpp"
+
+/* Protocole 1-Wire en trames UART, commun à la cible et à la
+ * simulation ; transfer() est dans oneWireUartDma.cpp */
+
+#define ONEWIRE_RESET_BAUD 9600
+#define ONEWIRE_SLOT_BAUD 115200
+// Impulsion de reset : 4 bits de données et le start à 0
+#define ONEWIRE_RESET_FRAME 0xF0
+// Slot d'écriture d'un 0 ; d'écriture d'un 1 ou de lecture
+#define ONEWIRE_SLOT_0 0x00
+#define ONEWIRE_SLOT_1 0xFF
+
+#define ONEWIRE_MATCH_ROM 0x55
+#define ONEWIRE_SKIP_ROM 0xCC
+#define ONEWIRE_SEARCH_ROM 0xF0
+
+uint8_t OneWireUart::reset()
+{
+    uint8_t frame = ONEWIRE_RESET_FRAME;
+    if (!transfer(&frame, 1, ONEWIRE_RESET_BAUD)) {
+        return 0;
+    }
+    // Les esclaves tirent la ligne pendant les bits de poids fort
+    return frame != ONEWIRE_RESET_FRAME;
+}
+
+void OneWireUart::select(const uint8_t rom[8])
+{
+    uint8_t cmd[9] = { ONEWIRE_MATCH_ROM };
+    memcpy(cmd + 1, rom, 8);
+    write_bytes(cmd, 9);
+}
+
+void OneWireUart::skip()
+{
+    write_byte(ONEWIRE_SKIP_ROM);
+}
+
+void OneWireUart::encode(const uint8_t *buf, uint16_t count)
+{
+    for (uint16_t i = 0; i < count; i++) {
+        for (int b = 0; b < 8; b++) {
+            _frames[i * 8 + b] = ((buf[i] >> b) & 1) ? ONEWIRE_SLOT_1 : ONEWIRE_SLOT_0;
+        }
+    }
+}
+
+void OneWireUart::decode(uint8_t *buf, uint16_t count)
+{
+    for (uint16_t i = 0; i < count; i++) {
+        uint8_t v = 0;
+        for (int b = 0; b < 8; b++) {
+            if (_frames[i * 8 + b] == ONEWIRE_SLOT_1) {
+                v |= 1 << b;
+            }
+        }
+        buf[i] = v;
+    }
+}
+
+void OneWireUart::write_bytes(const uint8_t *buf, uint16_t count, bool power)
+{
+    while (count > 0) {
+        uint16_t n = (count < BLOCK) ? count : BLOCK;
+        encode(buf, n);
+        transfer(_frames, n * 8, ONEWIRE_SLOT_BAUD);
+        buf += n;
+        count -= n;
+    }
+}
+
+void OneWireUart::write_byte(uint8_t v, uint8_t power)
+{
+    write_bytes(&v, 1);
+}
+
+void OneWireUart::read_bytes(uint8_t *buf, uint16_t count)
+{
+    while (count > 0) {
+        uint16_t n = (count < BLOCK) ? count : BLOCK;
+        memset(_frames, ONEWIRE_SLOT_1, n * 8);
+        if (!transfer(_frames, n * 8, ONEWIRE_SLOT_BAUD)) {
+            // Comme une ligne relâchée
+            memset(_frames, ONEWIRE_SLOT_1, n * 8);
+        }
+        decode(buf, n);
+        buf += n;
+        count -= n;
+    }
+}
+
+uint8_t OneWireUart::read_byte()
+{
+    uint8_t v;
+    read_bytes(&v, 1);
+    return v;
+}
+
+void OneWireUart::write_bit(uint8_t v)
+{
+    uint8_t frame = v ? ONEWIRE_SLOT_1 : ONEWIRE_SLOT_0;
+    transfer(&frame, 1, ONEWIRE_SLOT_BAUD);
+}
+
+uint8_t OneWireUart::read_bit()
+{
+    uint8_t frame = ONEWIRE_SLOT_1;
+    return transfer(&frame, 1, ONEWIRE_SLOT_BAUD) && frame == ONEWIRE_SLOT_1;
+}
+
+// ~~~~~~ Recherche des adresses (Maxim AN187) ~~~~~~~
+
+void OneWireUart::reset_search()
+{
+    memset(_rom, 0, sizeof(_rom));
+    _lastDiscrepancy = 0;
+    _lastFamilyDiscrepancy = 0;
+    _lastDevice = false;
+}
+
+void OneWireUart::target_search(uint8_t family_code)
+{
+    reset_search();
+    _rom[0] = family_code;
+    _lastDiscrepancy = 64;
+}
+
+uint8_t OneWireUart::search(uint8_t *newAddr)
+{
+    if (_lastDevice || !reset()) {
+        reset_search();
+        return 0;
+    }
+    write_byte(ONEWIRE_SEARCH_ROM);
+
+    int lastZero = 0;
+    for (int k = 1; k <= 64; k++) {
+        // Bit de l'adresse puis son complément, lus en un seul transfert
+        uint8_t frames[2] = { ONEWIRE_SLOT_1, ONEWIRE_SLOT_1 };
+        if (!transfer(frames, 2, ONEWIRE_SLOT_BAUD)) {
+            reset_search();
+            return 0;
+        }
+        int id = frames[0] == ONEWIRE_SLOT_1;
+        int cmp = frames[1] == ONEWIRE_SLOT_1;
+        if (id && cmp) {
+            // Plus aucun esclave ne participe
+            reset_search();
+            return 0;
+        }
+
+        uint8_t &byte = _rom[(k - 1) / 8];
+        uint8_t mask = 1 << ((k - 1) % 8);
+        int dir;
+        if (id != cmp) {
+            dir = id;
+        } else {
+            // Conflit : même branche qu'avant jusqu'au dernier, puis l'autre
+            dir = (k < _lastDiscrepancy) ? (byte & mask) != 0 : k == _lastDiscrepancy;
+            if (!dir) {
+                lastZero = k;
+                if (lastZero <= 8) {
+                    _lastFamilyDiscrepancy = lastZero;
+                }
+            }
+        }
+        byte = dir ? (byte | mask) : (byte & ~mask);
+        write_bit(dir);
+    }
+
+    _lastDiscrepancy = lastZero;
+    _lastDevice = (lastZero == 0);
+    if (_rom[0] == 0) {
+        reset_search();
+        return 0;
+    }
+    memcpy(newAddr, _rom, 8);
+    return 1;
+}
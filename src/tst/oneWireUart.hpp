@@ -0,0 +1,110 @@
+#ifndef __ONE_WIRE_UART_HPP__
+#define __ONE_WIRE_UART_HPP__
+#include "mbed.h"
+#include "OneWire.h"
+
+/* Maître 1-Wire sur l'USART2 en semi-duplex (STM32L4)
+ *
+ * La sortie TX, en collecteur ouvert avec le tirage de 4,7 kΩ du bus,
+ * est reliée en interne au récepteur : chaque trame émise revient en
+ * écho, modifiée par les esclaves qui tirent la ligne.
+ *   - reset : 0xF0 à 9600 bauds, ligne à 0 pendant 520 µs ; un écho
+ *     différent de 0xF0 est une impulsion de présence
+ *   - slot à 115200 bauds : 0x00 écrit un 0 (~78 µs à 0), 0xFF écrit
+ *     un 1 ou lit un bit (bit de start seul, 8,7 µs) ; un écho 0xFF
+ *     est un 1 lu
+ * Un octet vaut 8 trames, un scratchpad 72 : émission et écho passent
+ * par le DMA1 (canaux 7 et 6), le coeur dort pendant le transfert. Les
+ * slots ne dépendent que de l'horloge de l'USART, pas de wait_us ni des
+ * interruptions : rien à masquer, rien à recalibrer au réveil.
+ *
+ * Même interface que OneWire : Ds1820Bus l'utilise sans changement.
+ * Pas d'alimentation parasite : la ligne ne peut pas être forcée à 1.
+ *
+ * @code
+ * OneWireUart bus(A7);         // PA2, USART2_TX
+ * Ds1820Bus sondes(bus);
+ * @endcode
+ */
+class OneWireUart
+{
+public:
+    // tx : broche TX de l'USART2
+    OneWireUart(PinName tx);
+    ~OneWireUart();
+
+    // 1 si au moins un esclave répond
+    uint8_t reset(void);
+    void select(const uint8_t rom[8]);
+    void skip(void);
+    void write_byte(uint8_t v, uint8_t power = 0);
+    void write_bytes(const uint8_t *buf, uint16_t count, bool power = 0);
+    uint8_t read_byte(void);
+    void read_bytes(uint8_t *buf, uint16_t count);
+    void write_bit(uint8_t v);
+    uint8_t read_bit(void);
+    void depower(void) {}
+
+    // Recherche des adresses, comme OneWire::search
+    void reset_search(void);
+    void target_search(uint8_t family_code);
+    uint8_t search(uint8_t *newAddr);
+
+    static uint8_t crc8(const uint8_t *addr, uint8_t len) { return OneWire::crc8(addr, len); }
+
+private:
+    // Octets transférés en un seul DMA : un scratchpad
+    static const int BLOCK = 9;
+
+    UART_HandleTypeDef _uart;
+    DMA_HandleTypeDef _dmaTx;
+    DMA_HandleTypeDef _dmaRx;
+    EventFlags _transfer;       // écho reçu ou erreur DMA
+    uint8_t _frames[BLOCK * 8];
+    // État de la recherche
+    uint8_t _rom[8];
+    int _lastDiscrepancy;
+    int _lastFamilyDiscrepancy;
+    bool _lastDevice;
+
+    // Instance unique : USART2 et les canaux DMA sont fixes
+    static OneWireUart *_instance;
+
+    /* Émet n trames à baud et remplace chacune par son écho,
+     * false si le transfert n'a pas abouti */
+    bool transfer(uint8_t frames[], uint16_t n, uint32_t baud);
+    // Slots des bits de n octets, puis octets relus des échos
+    void encode(const uint8_t *buf, uint16_t count);
+    void decode(uint8_t *buf, uint16_t count);
+
+    // Interruption DMA1 canal 6 : écho complet
+    static void dmaIrq(void);
+    static void rxComplete(DMA_HandleTypeDef *dma);
+    static void rxError(DMA_HandleTypeDef *dma);
+
+    // disallow copy constructor and assignment operator
+    OneWireUart(const OneWireUart &);
+    OneWireUart &operator=(const OneWireUart &);
+};
+
+/* Transport du bus des sondes, choisi à la compilation par
+ * ONEWIRE_TRANSPORT
+ *
+ * ONEWIRE_GPIO : OneWire, slots tenus par wait_us sur une broche
+ * ONEWIRE_UART : OneWireUart, USART2 et DMA ; la broche TX de l'USART2
+ *                est celle de la liaison de debug
+ */
+#define ONEWIRE_GPIO 0
+#define ONEWIRE_UART 1
+
+#ifndef ONEWIRE_TRANSPORT
+#define ONEWIRE_TRANSPORT ONEWIRE_GPIO
+#endif
+
+#if ONEWIRE_TRANSPORT == ONEWIRE_UART
+typedef OneWireUart OneWireBus;
+#else
+typedef OneWire OneWireBus;
+#endif
+
+#endif
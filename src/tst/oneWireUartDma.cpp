@@ -0,0 +1,122 @@
+#if defined(TARGET_STM32L4)
+
+#include "oneWireUart.hpp"
+#include "pinmap.h"
+#include "PeripheralPins.h"
+
+/* Transport de OneWireUart : USART2 en semi-duplex, DMA1 canal 7 pour
+ * l'émission et canal 6 pour l'écho */
+
+#define TRANSFER_DONE 0x1
+#define TRANSFER_ERROR 0x2
+
+OneWireUart *OneWireUart::_instance = NULL;
+
+OneWireUart::OneWireUart(PinName tx)
+{
+    // Un seul maître possible : les périphériques sont fixes
+    MBED_ASSERT(_instance == NULL);
+    _instance = this;
+    reset_search();
+
+    _uart.Instance = (USART_TypeDef *)pinmap_peripheral(tx, PinMap_UART_TX);
+    MBED_ASSERT(_uart.Instance == USART2);
+    pinmap_pinout(tx, PinMap_UART_TX);
+    // Collecteur ouvert : le tirage du bus donne le niveau haut
+    pin_mode(tx, OpenDrainNoPull);
+
+    __HAL_RCC_USART2_CLK_ENABLE();
+    _uart.Init.BaudRate       = 0;      // fixé par transfer()
+    _uart.Init.WordLength     = UART_WORDLENGTH_8B;
+    _uart.Init.StopBits       = UART_STOPBITS_1;
+    _uart.Init.Parity         = UART_PARITY_NONE;
+    _uart.Init.Mode           = UART_MODE_TX_RX;     // écho reçu
+    _uart.Init.HwFlowCtl      = UART_HWCONTROL_NONE;
+    _uart.Init.OverSampling   = UART_OVERSAMPLING_16;
+    _uart.Init.OneBitSampling = UART_ONE_BIT_SAMPLE_DISABLE;
+    _uart.AdvancedInit.AdvFeatureInit = UART_ADVFEATURE_NO_INIT;
+
+    __HAL_RCC_DMA1_CLK_ENABLE();
+    _dmaTx.Instance                 = DMA1_Channel7;
+    _dmaTx.Init.Request             = DMA_REQUEST_2;        // USART2_TX
+    _dmaTx.Init.Direction           = DMA_MEMORY_TO_PERIPH;
+    _dmaTx.Init.PeriphInc           = DMA_PINC_DISABLE;
+    _dmaTx.Init.MemInc              = DMA_MINC_ENABLE;
+    _dmaTx.Init.PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
+    _dmaTx.Init.MemDataAlignment    = DMA_MDATAALIGN_BYTE;
+    _dmaTx.Init.Mode                = DMA_NORMAL;
+    _dmaTx.Init.Priority            = DMA_PRIORITY_MEDIUM;
+    _dmaRx.Instance                 = DMA1_Channel6;
+    _dmaRx.Init                     = _dmaTx.Init;
+    _dmaRx.Init.Request             = DMA_REQUEST_2;        // USART2_RX
+    _dmaRx.Init.Direction           = DMA_PERIPH_TO_MEMORY;
+    if (HAL_DMA_Init(&_dmaTx) != HAL_OK || HAL_DMA_Init(&_dmaRx) != HAL_OK) {
+        error("Cannot initialize DMA1 channels 6 and 7\n");
+    }
+    _dmaRx.XferCpltCallback  = &OneWireUart::rxComplete;
+    _dmaRx.XferErrorCallback = &OneWireUart::rxError;
+
+    NVIC_SetVector(DMA1_Channel6_IRQn, (uint32_t)&OneWireUart::dmaIrq);
+    NVIC_EnableIRQ(DMA1_Channel6_IRQn);
+}
+
+OneWireUart::~OneWireUart()
+{
+    NVIC_DisableIRQ(DMA1_Channel6_IRQn);
+    HAL_UART_DeInit(&_uart);
+    HAL_DMA_DeInit(&_dmaTx);
+    HAL_DMA_DeInit(&_dmaRx);
+    _instance = NULL;
+}
+
+bool OneWireUart::transfer(uint8_t frames[], uint16_t n, uint32_t baud)
+{
+    if (_uart.Init.BaudRate != baud) {
+        _uart.Init.BaudRate = baud;
+        if (HAL_HalfDuplex_Init(&_uart) != HAL_OK) {
+            return false;
+        }
+    }
+
+    // L'USART et le DMA s'arrêtent en mode stop : sleep seulement
+    DeepSleepLock lock;
+    USART_TypeDef *usart = _uart.Instance;
+    _transfer.clear();
+    __HAL_UART_CLEAR_FLAG(&_uart, UART_CLEAR_OREF | UART_CLEAR_NEF | UART_CLEAR_FEF);
+    __HAL_UART_SEND_REQ(&_uart, UART_RXDATA_FLUSH_REQUEST);
+
+    /* Même tampon en émission et en réception : l'écho de la trame i
+     * arrive après que le DMA a chargé la trame i + 1 */
+    HAL_DMA_Start_IT(&_dmaRx, (uint32_t)&usart->RDR, (uint32_t)frames, n);
+    HAL_DMA_Start(&_dmaTx, (uint32_t)frames, (uint32_t)&usart->TDR, n);
+    SET_BIT(usart->CR3, USART_CR3_DMAR | USART_CR3_DMAT);
+
+    // 10 bits par trame, avec une marge pour la première
+    uint32_t timeout_ms = 10000UL * n / baud + 2;
+    uint32_t flags = _transfer.wait_any(TRANSFER_DONE | TRANSFER_ERROR, timeout_ms);
+
+    CLEAR_BIT(usart->CR3, USART_CR3_DMAR | USART_CR3_DMAT);
+    HAL_DMA_Abort(&_dmaTx);
+    bool ok = !(flags & osFlagsError) && (flags & TRANSFER_DONE);
+    if (!ok) {
+        HAL_DMA_Abort(&_dmaRx);
+    }
+    return ok;
+}
+
+void OneWireUart::rxComplete(DMA_HandleTypeDef *dma)
+{
+    _instance->_transfer.set(TRANSFER_DONE);
+}
+
+void OneWireUart::rxError(DMA_HandleTypeDef *dma)
+{
+    _instance->_transfer.set(TRANSFER_ERROR);
+}
+
+void OneWireUart::dmaIrq()
+{
+    HAL_DMA_IRQHandler(&_instance->_dmaRx);
+}
+
+#endif
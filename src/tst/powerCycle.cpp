@@ -0,0 +1,74 @@
+#include "powerCycle.hpp"
+#include "WakeUp.h"
+
+// Réveil par l'alarme RTC
+#define WAKE_FLAG 0x1
+// Largeur de l'impulsion DONE, le TPL5110 en demande 100 ns
+#define DONE_PULSE_US 10
+// Sommeil minimal si le cycle a dépassé sa période
+#define SLEEP_MIN_MS 1000
+
+PowerCycle::PowerCycle(DigitalOut &done, uint32_t period_ms)
+    : _done(done), _period_ms(period_ms), _state(ACQUIRE), _since(0)
+{
+    for (int i = 0; i < STATES_NR; i++) {
+        _elapsed[i] = 0;
+    }
+    _done = 0;
+    _timer.start();
+}
+
+void PowerCycle::enter(State s)
+{
+    uint32_t now = _timer.read_high_resolution_us() / 1000;
+    _elapsed[_state] += now - _since;
+    _since = now;
+
+    // Nouveau cycle : le sommeil du précédent reste consultable
+    if (_state == SLEEP && s == ACQUIRE) {
+        for (int i = ACQUIRE; i < SLEEP; i++) {
+            _elapsed[i] = 0;
+        }
+    }
+    if (s == SLEEP) {
+        _elapsed[SLEEP] = 0;
+    }
+    _state = s;
+}
+
+void PowerCycle::sleep()
+{
+    enter(SLEEP);
+
+    // Demande de coupure au TPL5110
+    _done = 1;
+    wait_us(DONE_PULSE_US);
+    _done = 0;
+
+    // Toujours alimentée : réveil par l'alarme RTC à la fin de la période
+    uint32_t active = 0;
+    for (int i = ACQUIRE; i < SLEEP; i++) {
+        active += _elapsed[i];
+    }
+    uint32_t remaining = (active + SLEEP_MIN_MS < _period_ms) ? _period_ms - active : SLEEP_MIN_MS;
+
+    _wake.clear(WAKE_FLAG);
+    WakeUp::attach(callback(this, &PowerCycle::alarm));
+    WakeUp::set_ms(remaining);
+    // Le thread idle passe en mode stop si aucun DeepSleepLock n'est tenu
+    _wake.wait_any(WAKE_FLAG);
+}
+
+const char *PowerCycle::name(State s)
+{
+    static const char *const names[STATES_NR] = {
+        "acquire", "process", "transmit", "sleep"
+    };
+    return (s < STATES_NR) ? names[s] : "?";
+}
+
+// Contexte d'interruption
+void PowerCycle::alarm()
+{
+    _wake.set(WAKE_FLAG);
+}
@@ -0,0 +1,74 @@
+#ifndef __POWER_CYCLE_HPP__
+#define __POWER_CYCLE_HPP__
+#include "mbed.h"
+#include "rtos.h"
+
+/* Machine d'états du cycle de mesure : acquisition, traitement,
+ * émission puis sommeil
+ *
+ * Le temps passé dans chaque état est mesuré par un LowPowerTimer, qui
+ * continue de compter en deepsleep.
+ *
+ * sleep() termine le cycle : l'impulsion sur done demande au TPL5110 de
+ * couper l'alimentation jusqu'à sa prochaine période. Si la carte reste
+ * alimentée (USB, pas de TPL5110), l'alarme RTC de WakeUp la réveille
+ * après period_ms. En attendant, le thread est bloqué sur un EventFlags
+ * et le thread idle entre en mode stop dès que plus aucun
+ * DeepSleepLock n'est tenu : l'acquisition doit être arrêtée avant.
+ *
+ * @code
+ * PowerCycle power(done, 360000);
+ *
+ * while (1) {
+ *     power.enter(PowerCycle::ACQUIRE);
+ *     ...
+ *     power.enter(PowerCycle::TRANSMIT);
+ *     ...
+ *     power.sleep();
+ * }
+ * @endcode
+ */
+class PowerCycle
+{
+public:
+    enum State {
+        ACQUIRE,
+        PROCESS,
+        TRANSMIT,
+        SLEEP,
+        STATES_NR
+    };
+
+    /**
+     * @param done sortie DONE du TPL5110
+     * @param period_ms période du cycle quand l'alimentation est maintenue
+     */
+    PowerCycle(DigitalOut &done, uint32_t period_ms);
+
+    // Passe dans l'état s, le temps de l'état quitté est noté
+    void enter(State s);
+    State state(void) const { return _state; }
+    // Nouvelle période, prise en compte au prochain sleep()
+    void setPeriod(uint32_t period_ms) { _period_ms = period_ms; }
+
+    // Fin du cycle : coupure d'alimentation, à défaut sommeil jusqu'à l'alarme RTC
+    void sleep(void);
+
+    // Temps passé dans l'état s au cycle en cours, ou au précédent pour SLEEP
+    uint32_t elapsed_ms(State s) const { return _elapsed[s]; }
+    // Nom d'un état, pour les traces
+    static const char *name(State s);
+
+private:
+    DigitalOut &_done;
+    uint32_t _period_ms;
+    LowPowerTimer _timer;
+    EventFlags _wake;
+    State _state;
+    uint32_t _since;
+    uint32_t _elapsed[STATES_NR];
+
+    void alarm(void);
+};
+
+#endif
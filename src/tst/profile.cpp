@@ -0,0 +1,98 @@
+#include "profile.hpp"
+#include <math.h>
+#include <string.h>
+
+// Borne haute de la première classe de l'histogramme
+#define PROFILE_BUCKET0_US 250
+
+CycleProfile::CycleProfile(const ProfileConfig &config) : _config(config)
+{
+    MBED_ASSERT(config.phases <= PROFILE_PHASES_MAX);
+    clear();
+    for (int p = 0; p < PROFILE_PHASES_MAX; p++) {
+        _begin_us[p] = 0;
+    }
+}
+
+void CycleProfile::clear()
+{
+    memset(&_state, 0, sizeof(_state));
+}
+
+uint64_t CycleProfile::now_us(int p) const
+{
+    bool cpu = _config.cpu_phases & (1UL << p);
+    return ticker_read_us(cpu ? get_us_ticker_data() : get_lp_ticker_data());
+}
+
+void CycleProfile::begin(int p)
+{
+    _begin_us[p] = now_us(p);
+}
+
+void CycleProfile::end(int p)
+{
+    add(p, (uint32_t)(now_us(p) - _begin_us[p]));
+}
+
+void CycleProfile::add(int p, uint32_t us)
+{
+    ProfileState::Phase &phase = _state.phases[p];
+
+    // Classes x4 : nombre de bits de us/250, deux par classe
+    uint32_t q = us / PROFILE_BUCKET0_US;
+    int b = q ? (33 - __CLZ(q)) / 2 : 0;
+    if (b >= PROFILE_BUCKETS) {
+        b = PROFILE_BUCKETS - 1;
+    }
+    if (phase.histogram[b] < 255) {
+        phase.histogram[b]++;
+    }
+
+    if (phase.count < 0xFFFF) {
+        phase.count++;
+    }
+    if (us > phase.max_us) {
+        phase.max_us = us;
+    }
+    phase.total_us += us;
+}
+
+void CycleProfile::cycle()
+{
+    if (_state.cycles < 255) {
+        _state.cycles++;
+    }
+}
+
+uint32_t CycleProfile::mean_us(int p) const
+{
+    const ProfileState::Phase &phase = _state.phases[p];
+    return phase.count ? (uint32_t)(phase.total_us / phase.count) : 0;
+}
+
+uint32_t CycleProfile::bucketLimit_us(int b)
+{
+    return (b < PROFILE_BUCKETS - 1) ? PROFILE_BUCKET0_US << (2 * b) : UINT32_MAX;
+}
+
+float CycleProfile::charge_uc(int p) const
+{
+    // mA x µs = nC
+    return _config.current_ma[p] * _state.phases[p].total_us * 1e-3f;
+}
+
+float CycleProfile::energy_mj(int p) const
+{
+    return charge_uc(p) * _config.supply_v * 1e-3f;
+}
+
+int CycleProfile::encode(uint8_t frame[]) const
+{
+    float charge[PROFILE_PHASES_MAX];
+    for (int p = 0; p < _config.phases; p++) {
+        charge[p] = (_state.cycles && _state.phases[p].count)
+                    ? charge_uc(p) / _state.cycles : NAN;
+    }
+    return TelemetryCodec::encodeProfile(_state.cycles, charge, _config.phases, frame);
+}
@@ -0,0 +1,108 @@
+#ifndef __PROFILE_HPP__
+#define __PROFILE_HPP__
+#include "mbed.h"
+#include "telemetry.hpp"
+
+/* Profil temporel et énergétique du cycle de mesure
+ *
+ * Chaque phase du cycle (relevé d'un capteur, FFT, codage, émission,
+ * sommeil...) est chronométrée par begin()/end(), ou sa durée mesurée
+ * ailleurs est ajoutée par add(). Les phases de calcul sont lues sur le
+ * us ticker, à la microseconde ; les autres sur le lp ticker, qui
+ * continue de compter en deepsleep.
+ *
+ * Par phase sont tenus le nombre de passages, la durée totale et
+ * maximale, et un histogramme des durées en PROFILE_BUCKETS classes
+ * de largeur croissante (x4) : moins de 250 µs, de 250 µs à 1 ms, ...,
+ * plus de 1,024 s. La charge consommée est estimée avec le courant moyen
+ * déclaré pour chaque phase : celui du capteur pour un relevé, celui
+ * de la carte (MCU compris) pour les phases qui se suivent.
+ *
+ * L'état est une structure sans pointeur, sauvegardable telle quelle
+ * si la carte est mise hors tension entre deux cycles. Il couvre la
+ * fenêtre depuis le dernier clear(), au plus 255 cycles : la trame de
+ * profil (TelemetryCodec::encodeProfile) résume cette fenêtre.
+ *
+ * @code
+ * static const float COURANTS[2] = { 6.5f, 1.5f };     // mA
+ * static const ProfileConfig CONFIG = { 3.0f, COURANTS, 2, 0x1 };
+ * CycleProfile profile(CONFIG);
+ *
+ * profile.begin(FFT);
+ * ...
+ * profile.end(FFT);
+ * profile.add(DHT, dht.elapsed_us());
+ * profile.cycle();
+ * @endcode
+ */
+
+#define PROFILE_PHASES_MAX TELEMETRY_PROFILE_PHASES
+#define PROFILE_BUCKETS 8
+
+struct ProfileConfig {
+    float supply_v;             // tension d'alimentation, pour l'énergie
+    const float *current_ma;    // courant moyen de chaque phase
+    uint8_t phases;             // au plus PROFILE_PHASES_MAX
+    uint32_t cpu_phases;        // masque des phases chronométrées au us ticker
+};
+
+// État sauvegardable tel quel entre deux mises sous tension
+struct ProfileState {
+    uint8_t cycles;             // cycles de la fenêtre
+    struct Phase {
+        uint8_t histogram[PROFILE_BUCKETS];    // saturé à 255
+        uint16_t count;
+        uint32_t max_us;
+        float total_us;
+    } phases[PROFILE_PHASES_MAX];
+};
+
+class CycleProfile
+{
+public:
+    CycleProfile(const ProfileConfig &config);
+
+    // Nouvelle fenêtre
+    void clear(void);
+
+    // Début et fin de la phase p, sur le ticker de la phase
+    void begin(int p);
+    void end(int p);
+    // Passage de us µs dans la phase p, mesuré ailleurs
+    void add(int p, uint32_t us);
+    // Fin d'un cycle
+    void cycle(void);
+
+    uint8_t cycles(void) const { return _state.cycles; }
+    uint16_t count(int p) const { return _state.phases[p].count; }
+    uint32_t mean_us(int p) const;
+    uint32_t max_us(int p) const { return _state.phases[p].max_us; }
+    uint8_t histogram(int p, int b) const { return _state.phases[p].histogram[b]; }
+    // Borne haute de la classe b en µs, la dernière n'en a pas
+    static uint32_t bucketLimit_us(int b);
+
+    // Charge consommée par la phase p sur la fenêtre, en µC
+    float charge_uc(int p) const;
+    // Énergie correspondante en mJ
+    float energy_mj(int p) const;
+
+    /** Trame de profil : charge moyenne par cycle de chaque phase
+     * @param frame TELEMETRY_PROFILE_LEN octets
+     * @return nombre d'octets de la trame
+     */
+    int encode(uint8_t frame[]) const;
+
+    // Sauvegarde et restauration de l'état
+    const ProfileState &state(void) const { return _state; }
+    void restore(const ProfileState &state) { _state = state; }
+
+private:
+    const ProfileConfig &_config;
+    ProfileState _state;
+    // Début de la phase en cours, en RAM seulement
+    uint64_t _begin_us[PROFILE_PHASES_MAX];
+
+    uint64_t now_us(int p) const;
+};
+
+#endif
@@ -0,0 +1,88 @@
+#include "sensor.hpp"
+#include <string.h>
+
+SensorRegistry::SensorRegistry() : _count(0)
+{
+}
+
+bool SensorRegistry::add(Sensor *sensor)
+{
+    if (_count >= MAX_SENSORS) {
+        return false;
+    }
+    _sensors[_count++] = sensor;
+    return true;
+}
+
+int SensorRegistry::begin()
+{
+    int kept = 0;
+    for (int i = 0; i < _count; i++) {
+        if (_sensors[i]->begin()) {
+            _sensors[kept++] = _sensors[i];
+        }
+    }
+    _count = kept;
+    return _count;
+}
+
+int SensorRegistry::count() const
+{
+    return _count;
+}
+
+Sensor *SensorRegistry::at(int i) const
+{
+    return (i >= 0 && i < _count) ? _sensors[i] : NULL;
+}
+
+Sensor *SensorRegistry::find(const char *name) const
+{
+    for (int i = 0; i < _count; i++) {
+        if (strcmp(_sensors[i]->info().name, name) == 0) {
+            return _sensors[i];
+        }
+    }
+    return NULL;
+}
+
+bool SensorRegistry::schedule(Acquisition &cycle) const
+{
+    // Acquisition trie les tâches par délai décroissant
+    for (int i = 0; i < _count; i++) {
+        Sensor *s = _sensors[i];
+        if (!cycle.add(callback(s, &Sensor::trigger), callback(s, &Sensor::collect),
+                       s->info().conversion_ms, callback(s, &Sensor::ready),
+                       s->info().poll_ms)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void SensorRegistry::powerDown() const
+{
+    for (int i = 0; i < _count; i++) {
+        _sensors[i]->powerDown();
+    }
+}
+
+uint16_t SensorRegistry::latency() const
+{
+    uint16_t slowest = 0;
+    for (int i = 0; i < _count; i++) {
+        if (_sensors[i]->info().conversion_ms > slowest) {
+            slowest = _sensors[i]->info().conversion_ms;
+        }
+    }
+    return slowest;
+}
+
+uint32_t SensorRegistry::energy() const
+{
+    uint32_t sum = 0;
+    for (int i = 0; i < _count; i++) {
+        sum += _sensors[i]->info().energy_uj;
+    }
+    return sum;
+}
@@ -0,0 +1,118 @@
+#ifndef __SENSOR_HPP__
+#define __SENSOR_HPP__
+#include "mbed.h"
+#include "acquisition.hpp"
+
+/* Interface commune des capteurs de la ruche
+ *
+ * Un relevé se déroule en quatre temps : start() lance la conversion,
+ * ready() indique qu'elle est terminée, read() lit le résultat et
+ * powerDown() remet le capteur en veille. Chaque capteur déclare sa
+ * durée de conversion et l'énergie d'un relevé, ce qui permet à
+ * l'ordonnanceur de recouvrir les conversions.
+ */
+class Sensor
+{
+public:
+    // Caractéristiques déclarées par chaque capteur
+    struct Info {
+        const char *name;
+        uint16_t conversion_ms;     // délai minimal entre start() et read()
+        uint16_t poll_ms;           // période de test de ready()
+        uint16_t energy_uj;         // énergie d'un relevé complet
+    };
+
+    Sensor(const Info &info) : _info(info), _valid(false), _started_us(0), _elapsed_us(0) {}
+    virtual ~Sensor() {}
+
+    // Détection et initialisation au démarrage, false si absent
+    virtual bool begin(void) { return true; }
+    // Lance la conversion
+    virtual void start(void) {}
+    // Conversion terminée
+    virtual bool ready(void) { return true; }
+    // Lit le résultat, false en cas d'erreur
+    virtual bool read(void) = 0;
+    // Met le capteur en veille
+    virtual void powerDown(void) {}
+
+    // Nombre de valeurs fournies et valeur i du dernier relevé
+    virtual int count(void) const = 0;
+    virtual float value(int i) const = 0;
+
+    const Info &info(void) const { return _info; }
+    // Le dernier relevé a réussi
+    bool valid(void) const { return _valid; }
+    // Durée du dernier relevé, du lancement à la mise en veille, 0 si abandonné
+    uint32_t elapsed_us(void) const { return _elapsed_us; }
+
+    // Lancement d'un relevé : le précédent n'est plus valide
+    void trigger(void)
+    {
+        _valid = false;
+        _elapsed_us = 0;
+        _started_us = ticker_read_us(get_lp_ticker_data());
+        start();
+    }
+    // Relevé complet : lecture puis mise en veille
+    void collect(void)
+    {
+        _valid = read();
+        powerDown();
+        _elapsed_us = (uint32_t)(ticker_read_us(get_lp_ticker_data()) - _started_us);
+    }
+
+protected:
+    Info _info;
+
+private:
+    bool _valid;
+    // lp ticker : les conversions se font en deepsleep
+    uint64_t _started_us;
+    uint32_t _elapsed_us;
+};
+
+/* Liste des capteurs d'une ruche, parcourue par le cycle de mesure
+ *
+ * @code
+ * SensorRegistry capteurs;
+ * capteurs.add(&dhtExt);
+ * capteurs.add(&sondes);
+ * capteurs.begin();
+ *
+ * capteurs.schedule(cycle);       // une tâche par capteur présent
+ * cycle.run(2000);
+ * @endcode
+ */
+class SensorRegistry
+{
+public:
+    static const int MAX_SENSORS = 8;
+
+    SensorRegistry();
+
+    // Ajoute un capteur, false si la liste est pleine
+    bool add(Sensor *sensor);
+    // Initialise tous les capteurs, retire les absents
+    int begin(void);
+
+    int count(void) const;
+    Sensor *at(int i) const;
+    // Capteur de nom donné, NULL si inconnu
+    Sensor *find(const char *name) const;
+
+    // Ajoute au cycle une tâche par capteur, ordonnée par durée de conversion
+    bool schedule(Acquisition &cycle) const;
+    // Met en veille tous les capteurs, y compris ceux non relevés
+    void powerDown(void) const;
+    // Durée de conversion du capteur le plus lent
+    uint16_t latency(void) const;
+    // Énergie d'un relevé de tous les capteurs en µJ
+    uint32_t energy(void) const;
+
+private:
+    Sensor *_sensors[MAX_SENSORS];
+    int _count;
+};
+
+#endif
@@ -0,0 +1,110 @@
+#include "sensorDrivers.hpp"
+
+// ~~~~~~ DHT ~~~~~~~
+// Démarrage et trame en ~6 ms à 1,5 mA
+static const Sensor::Info DHT_INFO = { "dht", 6, 2, 30 };
+
+DhtSensor::DhtSensor(const char *name, DhtReader &dht) : Sensor(DHT_INFO), _dht(dht)
+{
+    _info.name = name;
+    _values[0] = _values[1] = 0;
+}
+
+void DhtSensor::start()
+{
+    _dht.start();
+}
+
+bool DhtSensor::ready()
+{
+    return _dht.done();
+}
+
+bool DhtSensor::read()
+{
+    if (_dht.error() != DhtReader::DHT_OK) {
+        return false;
+    }
+    _values[0] = _dht.temperature();
+    _values[1] = _dht.humidity();
+    return true;
+}
+
+// ~~~~~~ HX711 ~~~~~~~
+// Première conversion ~400 ms après le réveil à 10 Hz, 1,5 mA
+static const Sensor::Info HX711_INFO = { "hx711", 0, 10, 2000 };
+
+Hx711Sensor::Hx711Sensor(const char *name, HX711 &hx711, bool inverted)
+    : Sensor(HX711_INFO), _hx711(hx711), _inverted(inverted), _gram(0)
+{
+    _info.name = name;
+}
+
+void Hx711Sensor::start()
+{
+    _hx711.powerUp();
+}
+
+bool Hx711Sensor::ready()
+{
+    return _hx711.isReady();
+}
+
+bool Hx711Sensor::read()
+{
+    // Seule la conversion signalée par ready() : une seconde bloquerait 100 ms
+    _gram = _hx711.getGram(1);
+    if (_inverted) {
+        _gram = -_gram;
+    }
+    return true;
+}
+
+void Hx711Sensor::powerDown()
+{
+    _hx711.powerDown();
+}
+
+// ~~~~~~ DS1820 ~~~~~~~
+/* Conversion 94 ms en 9 bits à 750 ms en 12 bits, 1 mA par sonde
+ * pendant la conversion. Le bus est interrogé après la durée
+ * annoncée pour la résolution choisie */
+static const Sensor::Info DS1820_INFO = { "ds1820", 751, 20, 2500 };
+
+Ds1820Sensor::Ds1820Sensor(const char *name, OneWireBus &bus, uint8_t resolution)
+    : Sensor(DS1820_INFO), _probes(bus), _resolution(resolution)
+{
+    _info.name = name;
+}
+
+bool Ds1820Sensor::begin()
+{
+    // Adresses restaurées vérifiées, recherche si une sonde manque
+    int n = _probes.enumerate();
+    for (int i = 0; i < n; i++) {
+        _temps[i] = _probes.missing(i) ? NAN : 0;
+    }
+    // Les sondes notées absentes ne sont ni converties ni lues
+    n = _probes.present();
+    _probes.setResolution(_resolution);
+    // Énergie proportionnelle à la durée de conversion
+    _info.conversion_ms = _probes.conversion_ms();
+    _info.energy_uj = (uint32_t)DS1820_INFO.energy_uj * _info.conversion_ms
+                      / DS1820_INFO.conversion_ms * n;
+    return n > 0;
+}
+
+void Ds1820Sensor::start()
+{
+    _probes.convert();
+}
+
+bool Ds1820Sensor::ready()
+{
+    return _probes.done();
+}
+
+bool Ds1820Sensor::read()
+{
+    return _probes.readAll(_temps) == _probes.present();
+}
@@ -0,0 +1,82 @@
+#ifndef __SENSOR_DRIVERS_HPP__
+#define __SENSOR_DRIVERS_HPP__
+#include "sensor.hpp"
+#include "dhtReader.hpp"
+#include "ds1820Bus.hpp"
+#include "HX711.h"
+
+/* Adaptation des bibliothèques de capteurs à l'interface Sensor
+ * Énergies estimées d'après les datasheets, sous 3,3 V */
+
+/* DHT11/DHT22/AM2302 : value(0) température en °C, value(1) humidité en %
+ * La trame est reçue sous interruption pendant que les autres
+ * capteurs convertissent */
+class DhtSensor : public Sensor
+{
+public:
+    DhtSensor(const char *name, DhtReader &dht);
+
+    virtual void start(void);
+    virtual bool ready(void);
+    virtual bool read(void);
+    virtual int count(void) const { return 2; }
+    virtual float value(int i) const { return _values[i]; }
+
+private:
+    DhtReader &_dht;
+    float _values[2];
+};
+
+/* HX711 : value(0) masse en g
+ * La mise sous tension lance la conversion, DOUT passe à 0 quand
+ * elle est prête */
+class Hx711Sensor : public Sensor
+{
+public:
+    // inverted : cellule de charge montée à l'envers
+    Hx711Sensor(const char *name, HX711 &hx711, bool inverted = false);
+
+    virtual void start(void);
+    virtual bool ready(void);
+    virtual bool read(void);
+    virtual void powerDown(void);
+    virtual int count(void) const { return 1; }
+    virtual float value(int i) const { return _gram; }
+
+private:
+    HX711 &_hx711;
+    bool _inverted;
+    float _gram;
+};
+
+/* Sondes DS1820 d'un bus OneWire : value(i) température en °C de la
+ * sonde i, dans l'ordre de la liste de probes()
+ * Liste donnée par probes().add() ou trouvée par recherche, conservée
+ * via probes().state() et restore().
+ * Une seule conversion pour toutes les sondes, puis lecture des
+ * scratchpads à la suite */
+class Ds1820Sensor : public Sensor
+{
+public:
+    static const int MAX_PROBES = Ds1820Bus::MAX_PROBES;
+
+    // resolution : 9 à 12 bits, la conversion dure de 94 à 750 ms
+    Ds1820Sensor(const char *name, OneWireBus &bus, uint8_t resolution = 12);
+
+    // Vérifie ou recherche les sondes, false si aucune
+    virtual bool begin(void);
+    virtual void start(void);
+    virtual bool ready(void);
+    virtual bool read(void);
+    virtual int count(void) const { return _probes.count(); }
+    virtual float value(int i) const { return _temps[i]; }
+
+    Ds1820Bus &probes(void) { return _probes; }
+
+private:
+    Ds1820Bus _probes;
+    uint8_t _resolution;
+    float _temps[MAX_PROBES];
+};
+
+#endif
@@ -0,0 +1,122 @@
+#ifndef __SPSC_RING_HPP__
+#define __SPSC_RING_HPP__
+#include "mbed.h"
+#include "platform/mbed_atomic.h"
+
+/* File circulaire sans verrou, un producteur et un consommateur
+ *
+ * Pendant de platform/CircularBuffer.h pour le chemin des échantillons :
+ * CircularBuffer masque les interruptions à chaque accès, ici seuls les
+ * indices sont partagés. Le producteur (interruption, callback DMA)
+ * n'écrit que _head, le consommateur (thread de traitement) que _tail ;
+ * chacun publie son indice par un store release après avoir écrit ou
+ * lu les données, et lit celui de l'autre par un load acquire.
+ *
+ * Les indices sont libres sur 16 bits : N, puissance de 2, divise 2^16
+ * et size() = _head - _tail, même après débordement.
+ * Une file pleine refuse les nouveaux éléments, comptés par dropped() :
+ * le consommateur sait alors que le flux est discontinu.
+ *
+ * @code
+ * static SpscRing<int16_t, 256> ring;
+ *
+ * void isr() { ring.push(bloc, 64); }         // producteur
+ *
+ * int16_t x[64];
+ * uint16_t n = ring.pop(x, 64);               // consommateur
+ * @endcode
+ */
+template <typename T, uint16_t N>
+class SpscRing
+{
+    static_assert(N >= 2 && (N & (N - 1)) == 0 && N <= 0x8000,
+                  "N must be a power of 2, at most 2^15");
+
+public:
+    SpscRing() : _head(0), _tail(0), _dropped(0) {}
+
+    // Vide la file, producteur et consommateur à l'arrêt
+    void reset(void)
+    {
+        _head = 0;
+        _tail = 0;
+        _dropped = 0;
+    }
+
+    // ~~~~~~ Producteur ~~~~~~~
+
+    // Ajoute un élément, false si la file est pleine
+    bool push(const T &value)
+    {
+        return push(&value, 1) == 1;
+    }
+
+    /** Ajoute un bloc, entier ou pas du tout
+     * @return len, ou 0 si la place manque
+     */
+    uint16_t push(const T data[], uint16_t len)
+    {
+        uint16_t head = _head;
+        uint16_t tail = core_util_atomic_load_explicit_u16(&_tail, mbed_memory_order_acquire);
+        if ((uint16_t)(N - (uint16_t)(head - tail)) < len) {
+            _dropped++;
+            return 0;
+        }
+        for (uint16_t k = 0; k < len; k++) {
+            _buffer[(uint16_t)(head + k) & (N - 1)] = data[k];
+        }
+        core_util_atomic_store_explicit_u16(&_head, head + len, mbed_memory_order_release);
+        return len;
+    }
+
+    // Blocs refusés depuis reset()
+    uint16_t dropped(void) const
+    {
+        return core_util_atomic_load_u16(&_dropped);
+    }
+
+    // ~~~~~~ Consommateur ~~~~~~~
+
+    // Retire un élément, false si la file est vide
+    bool pop(T &value)
+    {
+        return pop(&value, 1) == 1;
+    }
+
+    /** Retire au plus len éléments
+     * @return nombre d'éléments retirés
+     */
+    uint16_t pop(T data[], uint16_t len)
+    {
+        uint16_t tail = _tail;
+        uint16_t head = core_util_atomic_load_explicit_u16(&_head, mbed_memory_order_acquire);
+        uint16_t n = head - tail;
+        if (n > len) {
+            n = len;
+        }
+        for (uint16_t k = 0; k < n; k++) {
+            data[k] = _buffer[(uint16_t)(tail + k) & (N - 1)];
+        }
+        core_util_atomic_store_explicit_u16(&_tail, tail + n, mbed_memory_order_release);
+        return n;
+    }
+
+    // ~~~~~~ Les deux côtés ~~~~~~~
+
+    // Éléments en attente, instantané
+    uint16_t size(void) const
+    {
+        return core_util_atomic_load_u16(&_head) - core_util_atomic_load_u16(&_tail);
+    }
+    bool empty(void) const { return size() == 0; }
+    bool full(void) const { return size() == N; }
+    static uint16_t capacity(void) { return N; }
+
+private:
+    T _buffer[N];
+    volatile uint16_t _head;        // écrit par le producteur
+    volatile uint16_t _tail;        // écrit par le consommateur
+    volatile uint16_t _dropped;     // écrit par le producteur
+};
+
+#endif
@@ -0,0 +1,317 @@
+#include "telemetry.hpp"
+#include <math.h>
+
+// ~~~~~~ Accès bit à bit ~~~~~~~
+
+BitWriter::BitWriter(uint8_t *buffer, int size)
+    : _buffer(buffer), _size(size), _pos(0)
+{
+    for (int i = 0; i < size; i++) {
+        buffer[i] = 0;
+    }
+}
+
+bool BitWriter::write(uint32_t value, int bits)
+{
+    if (_pos + bits > _size * 8) {
+        return false;
+    }
+    for (int b = bits - 1; b >= 0; b--, _pos++) {
+        if (value & (1UL << b)) {
+            _buffer[_pos >> 3] |= 0x80 >> (_pos & 7);
+        }
+    }
+    return true;
+}
+
+int BitWriter::bytes() const
+{
+    return (_pos + 7) >> 3;
+}
+
+BitReader::BitReader(const uint8_t *buffer, int size)
+    : _buffer(buffer), _size(size), _pos(0)
+{
+}
+
+bool BitReader::read(uint32_t &value, int bits)
+{
+    if (_pos + bits > _size * 8) {
+        return false;
+    }
+    value = 0;
+    for (int b = 0; b < bits; b++, _pos++) {
+        value = (value << 1) | ((_buffer[_pos >> 3] >> (7 - (_pos & 7))) & 1);
+    }
+    return true;
+}
+
+// ~~~~~~ Codec ~~~~~~~
+
+// Bits de l'en-tête : type et numéro de trame
+#define HEADER_SEQ_BITS 3
+#define HEADER_SEQ_MASK ((1 << HEADER_SEQ_BITS) - 1)
+// En-tête et numéro de première mesure d'une trame d'historique
+#define BATCH_HEADER 0xF
+#define BATCH_FIRST_BITS 8
+#define PROFILE_CYCLES_BITS 8
+#define PROFILE_CHARGE_BITS 6
+
+static inline uint32_t allOnes(int bits)
+{
+    return (1UL << bits) - 1;
+}
+
+// Entier signé vers non signé : 0, -1, 1, -2, 2... -> 0, 1, 2, 3, 4...
+static inline uint32_t zigzag(int32_t d)
+{
+    return ((uint32_t)d << 1) ^ (uint32_t)(d >> 31);
+}
+
+static inline int32_t unzigzag(uint32_t z)
+{
+    return (int32_t)(z >> 1) ^ -(int32_t)(z & 1);
+}
+
+TelemetryCodec::TelemetryCodec(const TelemetryField *schema, int fields)
+    : _schema(schema), _fields(fields)
+{
+    reset();
+}
+
+void TelemetryCodec::reset()
+{
+    _state.seq = 0;
+    _state.hasLast = 0;
+}
+
+int TelemetryCodec::bits() const
+{
+    int sum = 1 + HEADER_SEQ_BITS;
+    for (int i = 0; i < _fields; i++) {
+        sum += _schema[i].bits;
+    }
+    return sum;
+}
+
+uint32_t TelemetryCodec::quantize(int i, float v) const
+{
+    const TelemetryField &f = _schema[i];
+    uint32_t absent = allOnes(f.bits);
+    if (isnan(v)) {
+        return absent;
+    }
+    float q = floorf((v - f.min) / f.resolution + 0.5f);
+    if (q < 0) {
+        return 0;
+    }
+    if (q >= absent) {
+        return absent - 1;      // saturation
+    }
+    return (uint32_t)q;
+}
+
+float TelemetryCodec::value(int i, uint32_t q) const
+{
+    const TelemetryField &f = _schema[i];
+    if (q == allOnes(f.bits)) {
+        return NAN;
+    }
+    return f.min + q * f.resolution;
+}
+
+bool TelemetryCodec::deltaFits(const uint32_t q[]) const
+{
+    for (int i = 0; i < _fields; i++) {
+        const TelemetryField &f = _schema[i];
+        if (q[i] == allOnes(f.bits)) {
+            continue;           // absent, codé tel quel
+        }
+        if (_state.last[i] == allOnes(f.bits)) {
+            return false;       // pas de référence
+        }
+        if (zigzag((int32_t)q[i] - (int32_t)_state.last[i]) >= allOnes(f.delta_bits)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int TelemetryCodec::encode(const float values[], uint8_t frame[])
+{
+    if (_fields > TELEMETRY_FIELDS_MAX) {
+        return TELEMETRY_SCHEMA;
+    }
+
+    uint32_t q[TELEMETRY_FIELDS_MAX];
+    for (int i = 0; i < _fields; i++) {
+        q[i] = quantize(i, values[i]);
+    }
+
+    uint8_t seq = _state.hasLast ? (_state.seq + 1) & HEADER_SEQ_MASK : 0;
+    bool delta = _state.hasLast && (seq % TELEMETRY_KEYFRAME) != 0 && deltaFits(q);
+
+    BitWriter w(frame, TELEMETRY_FRAME_MAX);
+    w.write(delta ? 1 : 0, 1);
+    w.write(seq, HEADER_SEQ_BITS);
+    for (int i = 0; i < _fields; i++) {
+        const TelemetryField &f = _schema[i];
+        bool ok;
+        if (!delta) {
+            ok = w.write(q[i], f.bits);
+        } else if (q[i] == allOnes(f.bits)) {
+            ok = w.write(allOnes(f.delta_bits), f.delta_bits);
+        } else {
+            ok = w.write(zigzag((int32_t)q[i] - (int32_t)_state.last[i]), f.delta_bits);
+        }
+        if (!ok) {
+            return TELEMETRY_SCHEMA;
+        }
+    }
+
+    // La trame est considérée comme émise : elle devient la référence
+    for (int i = 0; i < _fields; i++) {
+        _state.last[i] = q[i];
+    }
+    _state.seq = seq;
+    _state.hasLast = 1;
+    return w.bytes();
+}
+
+int TelemetryCodec::decode(const uint8_t frame[], int len, float values[])
+{
+    if (_fields > TELEMETRY_FIELDS_MAX) {
+        return TELEMETRY_SCHEMA;
+    }
+
+    BitReader r(frame, len);
+    uint32_t delta, seq;
+    if (!r.read(delta, 1) || !r.read(seq, HEADER_SEQ_BITS)) {
+        return TELEMETRY_SHORT;
+    }
+    if (delta && (!_state.hasLast || seq != ((_state.seq + 1) & HEADER_SEQ_MASK))) {
+        return TELEMETRY_SEQUENCE;
+    }
+
+    uint32_t q[TELEMETRY_FIELDS_MAX];
+    for (int i = 0; i < _fields; i++) {
+        const TelemetryField &f = _schema[i];
+        uint32_t code;
+        if (!r.read(code, delta ? f.delta_bits : f.bits)) {
+            return TELEMETRY_SHORT;
+        }
+        if (!delta) {
+            q[i] = code;
+        } else if (code == allOnes(f.delta_bits)) {
+            q[i] = allOnes(f.bits);
+        } else if (_state.last[i] == allOnes(f.bits)) {
+            return TELEMETRY_SEQUENCE;
+        } else {
+            q[i] = (uint32_t)((int32_t)_state.last[i] + unzigzag(code));
+        }
+    }
+
+    for (int i = 0; i < _fields; i++) {
+        _state.last[i] = q[i];
+        values[i] = value(i, q[i]);
+    }
+    _state.seq = seq;
+    _state.hasLast = 1;
+    return TELEMETRY_OK;
+}
+
+int TelemetryCodec::batchSamples() const
+{
+    int sample = bits() - 1 - HEADER_SEQ_BITS;
+    return (TELEMETRY_FRAME_MAX * 8 - 1 - HEADER_SEQ_BITS - BATCH_FIRST_BITS) / sample;
+}
+
+int TelemetryCodec::encodeBatch(uint8_t first, const float values[], uint8_t frame[]) const
+{
+    int samples = batchSamples();
+    if (_fields > TELEMETRY_FIELDS_MAX || samples == 0) {
+        return TELEMETRY_SCHEMA;
+    }
+
+    BitWriter w(frame, TELEMETRY_FRAME_MAX);
+    w.write(BATCH_HEADER, 1 + HEADER_SEQ_BITS);
+    w.write(first, BATCH_FIRST_BITS);
+    for (int n = 0; n < samples; n++) {
+        for (int i = 0; i < _fields; i++) {
+            w.write(quantize(i, values[n * _fields + i]), _schema[i].bits);
+        }
+    }
+    return TELEMETRY_FRAME_MAX;
+}
+
+int TelemetryCodec::decodeBatch(const uint8_t frame[], int len, uint8_t &first,
+                                float values[]) const
+{
+    if (!isBatch(frame, len)) {
+        return TELEMETRY_SHORT;
+    }
+
+    BitReader r(frame, len);
+    uint32_t header, code;
+    r.read(header, 1 + HEADER_SEQ_BITS);
+    r.read(code, BATCH_FIRST_BITS);
+    first = (uint8_t)code;
+    int samples = batchSamples();
+    for (int n = 0; n < samples; n++) {
+        for (int i = 0; i < _fields; i++) {
+            if (!r.read(code, _schema[i].bits)) {
+                return TELEMETRY_SHORT;
+            }
+            values[n * _fields + i] = value(i, code);
+        }
+    }
+    return samples;
+}
+
+bool TelemetryCodec::isBatch(const uint8_t frame[], int len)
+{
+    return len == TELEMETRY_FRAME_MAX && (frame[0] >> 4) == BATCH_HEADER;
+}
+
+int TelemetryCodec::encodeProfile(uint8_t cycles, const float charge_uc[], int phases,
+                                  uint8_t frame[])
+{
+    uint32_t absent = allOnes(PROFILE_CHARGE_BITS);
+    BitWriter w(frame, TELEMETRY_PROFILE_LEN);
+    w.write(BATCH_HEADER, 1 + HEADER_SEQ_BITS);
+    w.write(cycles, PROFILE_CYCLES_BITS);
+    for (int i = 0; i < TELEMETRY_PROFILE_PHASES; i++) {
+        uint32_t q = absent;
+        if (i < phases && !isnan(charge_uc[i])) {
+            // 2*log2(1 + charge), de 0 à 2^31 µC
+            float code = roundf(2 * log2f(1 + fmaxf(charge_uc[i], 0)));
+            q = (code < absent) ? (uint32_t)code : absent - 1;
+        }
+        w.write(q, PROFILE_CHARGE_BITS);
+    }
+    return TELEMETRY_PROFILE_LEN;
+}
+
+int TelemetryCodec::decodeProfile(const uint8_t frame[], int len, uint8_t &cycles,
+                                  float charge_uc[])
+{
+    if (!isProfile(frame, len)) {
+        return TELEMETRY_SHORT;
+    }
+
+    BitReader r(frame, len);
+    uint32_t header, code;
+    r.read(header, 1 + HEADER_SEQ_BITS);
+    r.read(code, PROFILE_CYCLES_BITS);
+    cycles = (uint8_t)code;
+    for (int i = 0; i < TELEMETRY_PROFILE_PHASES; i++) {
+        r.read(code, PROFILE_CHARGE_BITS);
+        charge_uc[i] = (code == allOnes(PROFILE_CHARGE_BITS)) ? NAN : exp2f(code * 0.5f) - 1;
+    }
+    return TELEMETRY_OK;
+}
+
+bool TelemetryCodec::isProfile(const uint8_t frame[], int len)
+{
+    return len == TELEMETRY_PROFILE_LEN && (frame[0] >> 4) == BATCH_HEADER;
+}
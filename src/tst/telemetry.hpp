@@ -0,0 +1,170 @@
+#ifndef __TELEMETRY_HPP__
+#define __TELEMETRY_HPP__
+#include <stdint.h>
+
+/* Codage binaire des mesures pour une trame Sigfox de 12 octets
+ *
+ * Un schéma décrit chaque champ : valeur minimale, résolution, nombre
+ * de bits en absolu et en différentiel. Les valeurs sont quantifiées,
+ * saturées puis concaténées bit à bit, poids fort en tête.
+ *
+ * En-tête (4 bits) : 1 bit de type (0 absolu, 1 différentiel) puis
+ * un numéro de trame sur 3 bits. Une trame différentielle code l'écart
+ * avec la trame précédente, elle n'est émise que si tous les écarts
+ * tiennent sur leurs bits et au plus TELEMETRY_KEYFRAME-1 fois de suite.
+ * Le décodeur rejette une trame différentielle dont le numéro ne suit
+ * pas celui de la dernière trame décodée.
+ *
+ * Un champ absent (NaN) est codé par tous ses bits à 1.
+ *
+ * Trame d'historique (batch) : en-tête 1111, numéro de la première
+ * mesure sur 8 bits puis autant de jeux de valeurs absolues que la
+ * trame en contient. Elle fait toujours TELEMETRY_FRAME_MAX octets, le
+ * schéma doit donc garder ses trames différentielles plus courtes.
+ *
+ * Trame de profil : en-tête 1111, nombre de cycles sur 8 bits puis la
+ * charge moyenne par cycle de chaque phase sur 6 bits, en échelle
+ * logarithmique (pas de racine de 2, tous bits à 1 si absente). Elle
+ * fait toujours TELEMETRY_PROFILE_LEN octets, longueur qu'aucune autre
+ * trame ne doit avoir.
+ *
+ * Code portable sans mbed : le même fichier sert au décodeur du serveur.
+ */
+
+// Taille maximale d'une trame montante Sigfox
+#define TELEMETRY_FRAME_MAX 12
+// Champs par schéma
+#define TELEMETRY_FIELDS_MAX 16
+// Une trame absolue au moins toutes les TELEMETRY_KEYFRAME trames
+#define TELEMETRY_KEYFRAME 8
+// Trame de profil : longueur et nombre de phases
+#define TELEMETRY_PROFILE_LEN 11
+#define TELEMETRY_PROFILE_PHASES 12
+
+struct TelemetryField {
+    const char *name;
+    float min;              // valeur codée par 0
+    float resolution;       // pas de quantification
+    uint8_t bits;           // largeur en trame absolue
+    uint8_t delta_bits;     // largeur en trame différentielle
+};
+
+// Écriture bit à bit, poids fort en tête
+class BitWriter
+{
+public:
+    BitWriter(uint8_t *buffer, int size);
+    // false si le tampon est plein
+    bool write(uint32_t value, int bits);
+    // Octets utilisés, dernier octet complété par des 0
+    int bytes(void) const;
+
+private:
+    uint8_t *_buffer;
+    int _size;
+    int _pos;               // en bits
+};
+
+// Lecture bit à bit, poids fort en tête
+class BitReader
+{
+public:
+    BitReader(const uint8_t *buffer, int size);
+    // false si la trame est trop courte
+    bool read(uint32_t &value, int bits);
+
+private:
+    const uint8_t *_buffer;
+    int _size;
+    int _pos;
+};
+
+/* Référence du codage différentiel, sans pointeur : sauvegardable
+ * telle quelle si la carte est mise hors tension entre deux trames */
+struct TelemetryState {
+    // Valeurs quantifiées de la dernière trame, tous bits à 1 si absent
+    uint32_t last[TELEMETRY_FIELDS_MAX];
+    uint8_t seq;
+    uint8_t hasLast;
+};
+
+class TelemetryCodec
+{
+public:
+    enum Error {
+        TELEMETRY_OK = 0,
+        TELEMETRY_SHORT = -1,       // trame tronquée
+        TELEMETRY_SEQUENCE = -2,    // trame différentielle sans référence
+        TELEMETRY_SCHEMA = -3       // schéma trop grand pour une trame
+    };
+
+    TelemetryCodec(const TelemetryField *schema, int fields);
+
+    // Oublie la dernière trame : la prochaine sera absolue
+    void reset(void);
+
+    /** Code values[0 ... fields-1], NaN pour un champ absent
+     * @param frame TELEMETRY_FRAME_MAX octets
+     * @return nombre d'octets de la trame, ou Error
+     */
+    int encode(const float values[], uint8_t frame[]);
+
+    /** Décode une trame produite par encode()
+     * @param values fields valeurs, NaN pour un champ absent
+     * @return TELEMETRY_OK ou Error
+     */
+    int decode(const uint8_t frame[], int len, float values[]);
+
+    // Nombre de bits d'une trame absolue
+    int bits(void) const;
+
+    // Nombre de jeux de valeurs d'une trame d'historique
+    int batchSamples(void) const;
+    /** Code une trame d'historique, sans toucher à la référence
+     * @param first numéro de la première mesure
+     * @param values batchSamples()*fields valeurs
+     * @return nombre d'octets de la trame, ou Error
+     */
+    int encodeBatch(uint8_t first, const float values[], uint8_t frame[]) const;
+    /** Décode une trame d'historique
+     * @return nombre de jeux de valeurs, ou Error
+     */
+    int decodeBatch(const uint8_t frame[], int len, uint8_t &first, float values[]) const;
+    // La trame est une trame d'historique
+    static bool isBatch(const uint8_t frame[], int len);
+
+    /** Code une trame de profil
+     * @param cycles nombre de cycles résumés
+     * @param charge_uc charge moyenne par cycle de chaque phase en µC,
+     *        NaN si absente
+     * @param phases au plus TELEMETRY_PROFILE_PHASES
+     * @return nombre d'octets de la trame
+     */
+    static int encodeProfile(uint8_t cycles, const float charge_uc[], int phases,
+                             uint8_t frame[]);
+    /** Décode une trame de profil
+     * @param charge_uc TELEMETRY_PROFILE_PHASES charges, NaN si absente
+     * @return TELEMETRY_OK ou Error
+     */
+    static int decodeProfile(const uint8_t frame[], int len, uint8_t &cycles,
+                             float charge_uc[]);
+    // La trame est une trame de profil
+    static bool isProfile(const uint8_t frame[], int len);
+
+    // Sauvegarde et restauration de la référence
+    const TelemetryState &state(void) const { return _state; }
+    void restore(const TelemetryState &state) { _state = state; }
+
+    // Quantification d'une valeur du champ i et inverse
+    uint32_t quantize(int i, float value) const;
+    float value(int i, uint32_t q) const;
+
+private:
+    const TelemetryField *_schema;
+    int _fields;
+    TelemetryState _state;
+
+    bool deltaFits(const uint32_t q[]) const;
+};
+
+#endif
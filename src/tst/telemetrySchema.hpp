@@ -0,0 +1,82 @@
+#ifndef __TELEMETRY_SCHEMA_HPP__
+#define __TELEMETRY_SCHEMA_HPP__
+#include "telemetry.hpp"
+
+/* Contenu de la trame Sigfox de la ruche, partagé avec le décodeur
+ * du serveur : tout changement impose de redéployer les deux
+ *
+ * Trame absolue : 4 + 92 bits = 12 octets
+ * Trame différentielle : 4 + 48 bits = 7 octets
+ * Trame de profil : 4 + 8 + 12*6 bits = 11 octets
+ */
+enum HiveField {
+    HIVE_TEMP_EXT,      // °C, DHT extérieur
+    HIVE_TEMP_INT,      // °C, DHT intérieur
+    HIVE_HUM_EXT,       // %
+    HIVE_HUM_INT,       // %
+    HIVE_PROBE_LEFT,    // °C, sonde DS1820 gauche
+    HIVE_PROBE_RIGHT,   // °C, sonde DS1820 droite
+    HIVE_WEIGHT,        // g
+    HIVE_PEAK_FREQ,     // Hz, fréquence dominante
+    HIVE_PEAK_LEVEL,    // dB, amplitude de la raie dominante
+    HIVE_RMS_LEVEL,     // dB, niveau efficace du son
+    HIVE_CENTROID,      // Hz, centroïde spectral
+    HIVE_FIELDS_NR
+};
+
+static const TelemetryField HIVE_SCHEMA[HIVE_FIELDS_NR] = {
+    //  nom         min     pas    bits  delta
+    { "tempExt",   -20.0f,  0.5f,     8,  4 },  // -20 ... 107 °C
+    { "tempInt",   -20.0f,  0.5f,     8,  4 },
+    { "humExt",      0.0f,  1.0f,     7,  4 },  // 0 ... 126 %
+    { "humInt",      0.0f,  1.0f,     7,  4 },
+    { "probeLeft", -20.0f,  0.1f,    10,  5 },  // -20 ... 82,2 °C
+    { "probeRight",-20.0f,  0.1f,    10,  5 },
+    { "weight",      0.0f, 20.0f,    13,  6 },  // 0 ... 163,8 kg
+    { "peakFreq",    0.0f,  4.0f,     9,  5 },  // 0 ... 2040 Hz
+    { "peakLevel",   0.0f,  1.0f,     7,  4 },  // 0 ... 126 dB
+    { "rmsLevel",    0.0f,  1.0f,     7,  4 },
+    { "centroid",    0.0f, 32.0f,     6,  3 },  // 0 ... 2000 Hz
+};
+
+/* Historique envoyé par lots depuis le journal en flash : 3 mesures
+ * par trame de 12 octets (12 + 3*28 bits) */
+enum HistoryField {
+    HISTORY_WEIGHT,
+    HISTORY_TEMP_INT,
+    HISTORY_PEAK_LEVEL,
+    HISTORY_FIELDS_NR
+};
+
+static const TelemetryField HISTORY_SCHEMA[HISTORY_FIELDS_NR] = {
+    //  nom         min     pas    bits  delta
+    { "weight",      0.0f, 20.0f,    13,  0 },
+    { "tempInt",   -20.0f,  0.5f,     8,  0 },
+    { "peakLevel",   0.0f,  1.0f,     7,  0 },
+};
+
+/* Phases du cycle chronométrées par CycleProfile, dans l'ordre de la
+ * trame de profil. Les relevés des capteurs se recouvrent pendant
+ * l'acquisition ; le courant du MCU est compté dans les autres phases */
+enum HivePhase {
+    PHASE_PROBES,       // sondes DS1820, du lancement à la lecture
+    PHASE_WEIGHT,       // HX711
+    PHASE_DHT_EXT,
+    PHASE_DHT_INT,
+    PHASE_MIC,          // acquisition DMA du son
+    PHASE_ACQUIRE,      // attente des capteurs, MCU en sommeil
+    PHASE_FFT,          // Welch et descripteurs
+    PHASE_ENCODE,       // agrégation, codage, journal en flash
+    PHASE_STORE,        // écritures en flash avant la coupure
+    PHASE_UART,         // commande AT au modem
+    PHASE_LPWAN,        // émission radio par le modem
+    PHASE_SLEEP,        // alarme RTC, carte alimentée seulement
+    HIVE_PHASES_NR
+};
+
+static const char *const HIVE_PHASE_NAMES[HIVE_PHASES_NR] = {
+    "probes", "weight", "dhtExt", "dhtInt", "mic", "acquire",
+    "fft", "encode", "store", "uart", "lpwan", "sleep",
+};
+
+#endif
@@ -0,0 +1,101 @@
+//-------------------------------------------------------------------
+// Power spectrum estimation by Welch's method
+//      Overlapping frames of N samples are windowed and transformed
+//      in place by the kernels of the DSP backend and their power is
+//      accumulated bin by bin: one frame of N samples is the only
+//      buffer besides the accumulated power
+//-------------------------------------------------------------------
+
+#ifndef WELCH_HPP
+#define WELCH_HPP
+
+#include "fftReal.hpp"
+#include "audioDsp.hpp"
+
+/* Exemple :
+ * @code
+ * Welch<float, 256> spectre;          // fenêtre de Hann par défaut
+ *
+ * spectre.Execute(x, 512);            // 3 trames recouvrantes à 50 %
+ * float a = spectre.Abs(29);          // amplitude moyenne de la raie 29
+ * @endcode
+ */
+template <typename T, int N, Mikami::WindowType TYPE = Mikami::WINDOW_HANN,
+          typename DSP = AudioDsp>
+class Welch
+{
+public:
+    typedef typename Mikami::FftSample<T>::Cplx Cplx;
+    typedef Mikami::WindowTable<T, N, TYPE> Window;
+
+    Welch() { Reset(); }
+
+    // Clear accumulated power
+    void Reset()
+    {
+        for (int k=0; k<=N/2; k++) power_[k] = 0;
+        frames_ = 0;
+    }
+
+    // Add power spectrum of one frame of N samples
+    void Accumulate(const T x[])
+    {
+        DSP::Multiply(x, Window::W.data(), frame_, N);
+        fft_.Execute(frame_);
+        AddPower(frame_);
+        frames_++;
+    }
+
+    // Average of all frames of N samples within x[0] ... x[len-1],
+    // successive frames are "hop" samples apart (50 % overlap by default)
+    void Execute(const T x[], int len, int hop = N/2)
+    {
+        Reset();
+        for (int n=0; n+N<=len; n+=hop)
+            Accumulate(x + n);
+    }
+
+    // Number of frames averaged
+    int Frames() const { return frames_; }
+
+    // Mean power of bin k normalized by power of window,
+    // in units of input squared
+    float Power(int k) const
+    {
+        return (frames_ == 0) ? 0 : power_[k]/(frames_*Window::POWER);
+    }
+
+    // Root of mean power of bin k, comparable to |X[k]| of one frame
+    float Abs(int k) const { return sqrtf(Power(k)); }
+
+private:
+    // Float spectrum: squared magnitude by the backend, in place
+    void AddPower(float y[])
+    {
+        fft_.MagnitudeSquared(y);
+        for (int k=0; k<=N/2; k++)
+            power_[k] += y[k];
+    }
+
+    // Packed fixed-point spectrum, squared in float to keep small bins
+    template <typename Q>
+    void AddPower(const Q y[])
+    {
+        int e2 = 2*fft_.Exponent();
+        float re0 = y[0], reHalf = y[1];
+        power_[0] += ldexpf(re0*re0, e2);
+        power_[N/2] += ldexpf(reHalf*reHalf, e2);
+        for (int k=1; k<N/2; k++)
+        {
+            float re = y[2*k], im = y[2*k+1];
+            power_[k] += ldexpf(re*re + im*im, e2);
+        }
+    }
+
+    typename DSP::template FftInPlace<T, N> fft_;
+    T     frame_[N];        // windowed frame, then its packed spectrum
+    float power_[N/2+1];    // accumulated power
+    int   frames_;
+};
+
+#endif  // WELCH_HPP